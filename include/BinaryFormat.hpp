@@ -0,0 +1,312 @@
+// author: avivoz4@gmail.com
+
+/**
+ * @file BinaryFormat.hpp
+ * @brief Versioned binary file format used by MyContainer::save and load
+ * @author Aviv Oz
+ * @email avivoz4@gmail.com
+ *
+ * A file is a 64-byte header followed by the payload. The header records a
+ * format version, a tag for the element type, the element size, the byte
+ * order of the writer, the element count, the payload size and a 64-bit
+ * FNV-1a checksum of the payload. Trivially copyable elements are stored as
+ * one raw block in native byte order, so the payload can be read straight
+ * into element storage or mapped in place. std::string elements are stored
+ * as a 64-bit length followed by the characters.
+ */
+
+#pragma once
+#include <string>
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+#include <system_error>
+#include <unistd.h>
+#include <sys/uio.h>
+#include <sys/stat.h>
+
+namespace containers {
+namespace detail {
+
+    /**
+     * @brief Element type recorded in a file, checked when loading
+     */
+    enum class TypeTag : uint32_t {
+        SignedInteger = 1,
+        UnsignedInteger = 2,
+        FloatingPoint = 3,
+        Raw = 4,      ///< Any other trivially copyable type, identified by its size
+        String = 5
+    };
+
+    /**
+     * @brief Whether the binary format can store elements of type T
+     */
+    template<typename T>
+    struct is_serializable : std::integral_constant<bool,
+        std::is_trivially_copyable<T>::value || std::is_same<T, std::string>::value> {};
+
+    template<typename T>
+    constexpr TypeTag type_tag() {
+        if constexpr (std::is_same<T, std::string>::value) return TypeTag::String;
+        else if constexpr (std::is_floating_point<T>::value) return TypeTag::FloatingPoint;
+        else if constexpr (std::is_integral<T>::value && std::is_signed<T>::value) return TypeTag::SignedInteger;
+        else if constexpr (std::is_integral<T>::value) return TypeTag::UnsignedInteger;
+        else return TypeTag::Raw;
+    }
+
+    /**
+     * @brief Layout of the first 64 bytes of a file
+     */
+    struct BinaryHeader {
+        char magic[4];          ///< "MYCB"
+        uint32_t version;       ///< Format version, binary_version when written
+        uint32_t type_tag;      ///< TypeTag of the elements
+        uint32_t element_size;  ///< sizeof(T), or 1 for strings
+        uint32_t byte_order;    ///< byte_order_mark as written by the saving machine
+        uint32_t reserved;      ///< Zero
+        uint64_t count;         ///< Number of elements
+        uint64_t payload_bytes; ///< Bytes following the header
+        uint64_t checksum;      ///< FNV-1a of the payload
+        char padding[16];       ///< Zero, pads the header to 64 bytes
+    };
+    static_assert(sizeof(BinaryHeader) == 64, "BinaryHeader must stay 64 bytes");
+
+    constexpr char binary_magic[4] = {'M', 'Y', 'C', 'B'};
+    constexpr uint32_t binary_version = 1;
+    constexpr uint32_t byte_order_mark = 0x01020304;
+
+    /**
+     * @brief Incremental 64-bit FNV-1a hash
+     */
+    class Checksum {
+    private:
+        uint64_t state = 14695981039346656037ull;
+
+    public:
+        /**
+         * @brief Feeds bytes into the hash
+         * Time Complexity: O(bytes)
+         */
+        void update(const void* data, size_t bytes) {
+            const unsigned char* p = static_cast<const unsigned char*>(data);
+            for (size_t i = 0; i < bytes; ++i) {
+                state = (state ^ p[i]) * 1099511628211ull;
+            }
+        }
+
+        uint64_t value() const { return state; }
+    };
+
+    /**
+     * @brief Builds the header for a payload of elements of type T
+     * Time Complexity: O(1)
+     */
+    template<typename T>
+    BinaryHeader make_header(size_t count, size_t payload_bytes, uint64_t checksum) {
+        BinaryHeader header{};
+        std::memcpy(header.magic, binary_magic, sizeof(binary_magic));
+        header.version = binary_version;
+        header.type_tag = static_cast<uint32_t>(type_tag<T>());
+        header.element_size = std::is_same<T, std::string>::value ? 1 : static_cast<uint32_t>(sizeof(T));
+        header.byte_order = byte_order_mark;
+        header.count = count;
+        header.payload_bytes = payload_bytes;
+        header.checksum = checksum;
+        return header;
+    }
+
+    /**
+     * @brief Checks that a header describes elements of type T
+     * @throws std::runtime_error naming the first mismatch
+     * Time Complexity: O(1)
+     */
+    template<typename T>
+    void check_header(const BinaryHeader& header) {
+        if (std::memcmp(header.magic, binary_magic, sizeof(binary_magic)) != 0) {
+            throw std::runtime_error("Not a MyContainer binary file");
+        }
+        if (header.version != binary_version) {
+            throw std::runtime_error("Unsupported binary format version");
+        }
+        if (header.byte_order != byte_order_mark) {
+            throw std::runtime_error("File was written with a different byte order");
+        }
+        BinaryHeader expected = make_header<T>(0, 0, 0);
+        if (header.type_tag != expected.type_tag || header.element_size != expected.element_size) {
+            throw std::runtime_error("File holds a different element type");
+        }
+        if constexpr (std::is_trivially_copyable<T>::value) {
+            if (header.count > std::numeric_limits<uint64_t>::max() / sizeof(T) ||
+                header.payload_bytes != header.count * sizeof(T)) {
+                throw std::runtime_error("Payload size does not match the element count");
+            }
+        } else {
+            // Every string carries at least its 64-bit length prefix
+            if (header.count > header.payload_bytes / sizeof(uint64_t)) {
+                throw std::runtime_error("Payload size does not match the element count");
+            }
+        }
+        if (header.payload_bytes > std::numeric_limits<size_t>::max()) {
+            throw std::runtime_error("Payload does not fit in memory");
+        }
+    }
+
+    /**
+     * @brief Checks that a regular file still holds the given number of bytes
+     * @param fd File descriptor positioned at the start of the payload
+     * @param bytes Payload size claimed by the header
+     * @return true if fd is a regular file holding the payload, false if its
+     * size cannot be known in advance, as for a pipe or socket
+     * @throws std::runtime_error if a regular file is shorter than the payload
+     * @throws std::system_error if fstat fails
+     * Time Complexity: O(1)
+     */
+    inline bool check_available(int fd, uint64_t bytes) {
+        struct stat info;
+        if (::fstat(fd, &info) != 0) throw std::system_error(errno, std::generic_category(), "fstat");
+        if (!S_ISREG(info.st_mode)) return false;
+        off_t position = ::lseek(fd, 0, SEEK_CUR);
+        if (position < 0) return false;
+        if (info.st_size < position || static_cast<uint64_t>(info.st_size - position) < bytes) {
+            throw std::runtime_error("Unexpected end of input");
+        }
+        return true;
+    }
+
+    /**
+     * @brief Writes every byte of the given buffers with a single writev where possible
+     * @param fd File descriptor to write to
+     * @param parts Buffers in order; advanced in place on partial writes
+     * @param n Number of buffers
+     * @throws std::system_error if writing fails
+     * Time Complexity: O(total bytes)
+     */
+    inline void write_all(int fd, iovec* parts, int n) {
+        while (n > 0) {
+            ssize_t written = ::writev(fd, parts, n);
+            if (written < 0) {
+                if (errno == EINTR) continue;
+                throw std::system_error(errno, std::generic_category(), "writev");
+            }
+            size_t left = static_cast<size_t>(written);
+            while (n > 0 && left >= parts->iov_len) {
+                left -= parts->iov_len;
+                ++parts;
+                --n;
+            }
+            if (n > 0) {
+                parts->iov_base = static_cast<char*>(parts->iov_base) + left;
+                parts->iov_len -= left;
+            }
+        }
+    }
+
+    /**
+     * @brief Reads exactly bytes bytes
+     * @throws std::system_error if reading fails
+     * @throws std::runtime_error if the input ends first
+     * Time Complexity: O(bytes)
+     */
+    inline void read_exact(int fd, void* data, size_t bytes) {
+        char* target = static_cast<char*>(data);
+        while (bytes > 0) {
+            ssize_t got = ::read(fd, target, bytes);
+            if (got < 0) {
+                if (errno == EINTR) continue;
+                throw std::system_error(errno, std::generic_category(), "read");
+            }
+            if (got == 0) {
+                throw std::runtime_error("Unexpected end of input");
+            }
+            target += got;
+            bytes -= static_cast<size_t>(got);
+        }
+    }
+
+    /**
+     * @brief Reads count values into a vector-like buffer and adds them to a checksum
+     * @param fd File descriptor to read from
+     * @param buffer Empty buffer with resize() and data()
+     * @param count Number of values to read
+     * @param verified Whether the input is known to hold count values
+     * @param checksum Checksum updated with the bytes read
+     * @throws std::runtime_error if the input ends early
+     * @throws std::system_error if reading fails
+     * Time Complexity: O(count)
+     *
+     * Verified input is read in one piece. Otherwise count comes from an
+     * unchecked header, so the buffer grows geometrically from 1 MiB as data
+     * actually arrives and a truncated stream never allocates more than twice
+     * what it delivered.
+     */
+    template<typename Buffer>
+    void read_values(int fd, Buffer& buffer, size_t count, bool verified, Checksum& checksum) {
+        using Value = typename Buffer::value_type;
+        const size_t chunk = std::max<size_t>(1, (size_t(1) << 20) / sizeof(Value));
+        size_t done = 0;
+        while (done < count) {
+            size_t n = count - done;
+            if (!verified) n = std::min(n, std::max(done, chunk));
+            buffer.resize(done + n);
+            read_exact(fd, buffer.data() + done, n * sizeof(Value));
+            checksum.update(buffer.data() + done, n * sizeof(Value));
+            done += n;
+        }
+    }
+
+    /**
+     * @brief Appends a length-prefixed string to a payload
+     * Time Complexity: O(length)
+     */
+    inline void encode_string(std::vector<char>& out, const std::string& value) {
+        uint64_t length = value.size();
+        const char* prefix = reinterpret_cast<const char*>(&length);
+        out.insert(out.end(), prefix, prefix + sizeof(length));
+        out.insert(out.end(), value.begin(), value.end());
+    }
+
+    /**
+     * @brief Decodes count length-prefixed strings
+     * @param first Start of the payload
+     * @param last End of the payload
+     * @param count Number of strings expected
+     * @param emit Callable taking (const char* data, size_t length) for each string
+     * @throws std::runtime_error if the payload is malformed
+     * Time Complexity: O(payload bytes)
+     */
+    template<typename Emit>
+    void decode_strings(const char* first, const char* last, size_t count, Emit emit) {
+        for (size_t i = 0; i < count; ++i) {
+            uint64_t length;
+            if (static_cast<size_t>(last - first) < sizeof(length)) {
+                throw std::runtime_error("Corrupt string payload");
+            }
+            std::memcpy(&length, first, sizeof(length));
+            first += sizeof(length);
+            if (static_cast<uint64_t>(last - first) < length) {
+                throw std::runtime_error("Corrupt string payload");
+            }
+            emit(first, static_cast<size_t>(length));
+            first += length;
+        }
+        if (first != last) {
+            throw std::runtime_error("Corrupt string payload");
+        }
+    }
+
+    /**
+     * @brief Closes a file descriptor when leaving scope
+     */
+    struct FileCloser {
+        int fd;
+        ~FileCloser() { if (fd >= 0) ::close(fd); }
+    };
+}
+}
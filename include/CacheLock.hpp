@@ -0,0 +1,77 @@
+// author: avivoz4@gmail.com
+
+/**
+ * @file CacheLock.hpp
+ * @brief Lock around the caches MyContainer fills in from const member functions
+ * @author Aviv Oz
+ * @email avivoz4@gmail.com
+ *
+ * Sorted views and hash index lookups are const, yet the first one after a
+ * modification builds the sorted permutation, the maintained order or the
+ * index. Several threads may read one container at once, so those builds run
+ * under a mutex. Once a build is complete the lock records the version it
+ * belongs to, and readers that find their version recorded skip the mutex.
+ */
+
+#pragma once
+#include <mutex>
+#include <atomic>
+#include <cstddef>
+
+namespace containers {
+namespace detail {
+
+    /**
+     * @brief Mutex plus the version whose caches are complete
+     *
+     * Copies and assignments start out unlocked with no version recorded,
+     * since the caches they guard are copied separately.
+     */
+    class CacheLock {
+    private:
+        static constexpr size_t none = static_cast<size_t>(-1);
+
+        std::mutex mutex;                   ///< Serializes cache builds
+        std::atomic<size_t> complete{none}; ///< Version whose caches need no more work
+
+    public:
+        CacheLock() = default;
+        CacheLock(const CacheLock&) noexcept {}
+
+        CacheLock& operator=(const CacheLock&) noexcept {
+            forget();
+            return *this;
+        }
+
+        void lock() { mutex.lock(); }
+        void unlock() { mutex.unlock(); }
+
+        /**
+         * @brief Whether the caches were completed for the given version
+         * Time Complexity: O(1)
+         *
+         * A true result also makes everything written before mark_ready()
+         * visible to the calling thread.
+         */
+        bool ready(size_t version) const {
+            return complete.load(std::memory_order_acquire) == version;
+        }
+
+        /**
+         * @brief Records that the caches need no more work at the given version
+         * Time Complexity: O(1)
+         */
+        void mark_ready(size_t version) {
+            complete.store(version, std::memory_order_release);
+        }
+
+        /**
+         * @brief Drops the recorded version after a change the version does not reflect
+         * Time Complexity: O(1)
+         */
+        void forget() {
+            complete.store(none, std::memory_order_relaxed);
+        }
+    };
+}
+}
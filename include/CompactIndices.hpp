@@ -0,0 +1,298 @@
+// author: avivoz4@gmail.com
+
+/**
+ * @file CompactIndices.hpp
+ * @brief Index permutation stored in the narrowest integer type that fits
+ * @author Aviv Oz
+ * @email avivoz4@gmail.com
+ *
+ * Sorted views read element indices through a permutation of 0..n-1. Most
+ * containers are far smaller than 2^32 elements, so the indices are stored
+ * as uint16_t up to 65536 elements, as uint32_t below 2^32 and as uint64_t
+ * only beyond that. Narrower entries halve or quarter the permutation memory
+ * and fit more of it in cache while iterating in sorted order. Containers
+ * with inline element storage keep small permutations inline as well.
+ */
+
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <array>
+#include <type_traits>
+
+namespace containers {
+namespace detail {
+
+    /**
+     * @brief Permutation of element indices with a width chosen by its size
+     * @tparam Alloc Allocator the entries are obtained from, rebound per width
+     * @tparam Inline Number of entries stored inside the object, 0 for none
+     *
+     * Exactly one of the inline array and the three vectors is in use at a
+     * time. Algorithms run on the typed entries through visit(), so sorting
+     * works on the narrow type directly; single reads go through operator[].
+     */
+    template<typename Alloc = std::allocator<size_t>, size_t Inline = 0>
+    class CompactIndices {
+        static_assert(Inline <= 65536, "Inline permutations hold at most 2^16 entries");
+
+    private:
+        template<typename U>
+        using rebind = typename std::allocator_traits<Alloc>::template rebind_alloc<U>;
+        using Local = std::conditional_t<(Inline <= 256), uint8_t, uint16_t>;
+
+        std::array<Local, Inline> local{};              ///< Entries while size() <= Inline
+        size_t local_size = 0;                          ///< Number of inline entries in use
+        std::vector<uint16_t, rebind<uint16_t>> narrow; ///< Entries while size() <= 2^16
+        std::vector<uint32_t, rebind<uint32_t>> medium; ///< Entries while size() <= 2^32
+        std::vector<uint64_t, rebind<uint64_t>> wide;   ///< Entries beyond that
+        unsigned width = 0;                             ///< Bytes per heap entry in use: 2, 4 or 8, or 0 for inline
+
+        /**
+         * @brief Frees a vector's storage, keeping its allocator
+         * Time Complexity: O(1)
+         */
+        template<typename Vector>
+        static void release(Vector& v) {
+            Vector(v.get_allocator()).swap(v);
+        }
+
+        /**
+         * @brief Fills a vector with 0..n-1 and releases the other two
+         * Time Complexity: O(n)
+         */
+        template<typename Vector>
+        void fill(Vector& target, size_t n) {
+            using Index = typename Vector::value_type;
+            if (static_cast<void*>(&target) != &narrow) release(narrow);
+            if (static_cast<void*>(&target) != &medium) release(medium);
+            if (static_cast<void*>(&target) != &wide) release(wide);
+            target.resize(n);
+            for (size_t i = 0; i < n; ++i) {
+                target[i] = static_cast<Index>(i);
+            }
+            local_size = 0;
+            width = sizeof(Index);
+        }
+
+    public:
+        CompactIndices() = default;
+
+        /**
+         * @brief Creates an empty permutation drawing memory from alloc
+         * @param alloc Allocator for the entries
+         */
+        explicit CompactIndices(const Alloc& alloc) :
+            narrow(rebind<uint16_t>(alloc)),
+            medium(rebind<uint32_t>(alloc)),
+            wide(rebind<uint64_t>(alloc)) {}
+
+        /**
+         * @brief Copies a permutation into memory from alloc
+         * @param other Permutation to copy
+         * @param alloc Allocator for the copy's entries
+         * Time Complexity: O(n)
+         */
+        CompactIndices(const CompactIndices& other, const Alloc& alloc) :
+            narrow(other.narrow, rebind<uint16_t>(alloc)),
+            medium(other.medium, rebind<uint32_t>(alloc)),
+            wide(other.wide, rebind<uint64_t>(alloc)),
+            width(other.width) {
+            local = other.local;
+            local_size = other.local_size;
+        }
+
+        /**
+         * @brief Replaces the contents with the identity permutation 0..n-1
+         * @param n Number of elements
+         * Time Complexity: O(n)
+         */
+        void assign_identity(size_t n) {
+            if (n <= Inline) {
+                release(narrow);
+                release(medium);
+                release(wide);
+                for (size_t i = 0; i < n; ++i) {
+                    local[i] = static_cast<Local>(i);
+                }
+                local_size = n;
+                width = 0;
+            } else if (n <= size_t(std::numeric_limits<uint16_t>::max()) + 1) {
+                fill(narrow, n);
+            } else if (n - 1 <= std::numeric_limits<uint32_t>::max()) {
+                fill(medium, n);
+            } else {
+                fill(wide, n);
+            }
+        }
+
+        /**
+         * @brief Returns the number of entries
+         * Time Complexity: O(1)
+         */
+        size_t size() const {
+            switch (width) {
+                case 0: return local_size;
+                case 2: return narrow.size();
+                case 4: return medium.size();
+                default: return wide.size();
+            }
+        }
+
+        /**
+         * @brief Returns the entry at a position
+         * @param i Position, must be less than size()
+         * @return The element index stored there
+         * Time Complexity: O(1)
+         */
+        size_t operator[](size_t i) const {
+            switch (width) {
+                case 0: return local[i];
+                case 2: return narrow[i];
+                case 4: return medium[i];
+                default: return static_cast<size_t>(wide[i]);
+            }
+        }
+
+        /**
+         * @brief Runs a callable on the typed entries
+         * @param f Callable taking (Index* first, Index* last)
+         * @return Whatever f returns
+         * Time Complexity: That of f
+         */
+        template<typename F>
+        decltype(auto) visit(F&& f) {
+            if constexpr (Inline > 0) {
+                if (width == 0) return f(local.data(), local.data() + local_size);
+            }
+            switch (width) {
+                case 2: return f(narrow.data(), narrow.data() + narrow.size());
+                case 4: return f(medium.data(), medium.data() + medium.size());
+                default: return f(wide.data(), wide.data() + wide.size());
+            }
+        }
+
+        /**
+         * @brief Runs a callable on the typed entries without modifying them
+         * @param f Callable taking (const Index* first, const Index* last)
+         * @return Whatever f returns
+         */
+        template<typename F>
+        decltype(auto) visit(F&& f) const {
+            if constexpr (Inline > 0) {
+                if (width == 0) return f(local.data(), local.data() + local_size);
+            }
+            switch (width) {
+                case 2: return f(narrow.data(), narrow.data() + narrow.size());
+                case 4: return f(medium.data(), medium.data() + medium.size());
+                default: return f(wide.data(), wide.data() + wide.size());
+            }
+        }
+
+        /**
+         * @brief Heap memory held by the entries
+         * @return Bytes of capacity in the vector in use; inline entries count as part of the object
+         * Time Complexity: O(1)
+         */
+        size_t memory_usage() const {
+            return narrow.capacity() * sizeof(uint16_t)
+                + medium.capacity() * sizeof(uint32_t)
+                + wide.capacity() * sizeof(uint64_t);
+        }
+    };
+
+    /**
+     * @brief Holds the sorted permutation of one container
+     * @tparam Indices CompactIndices instantiation
+     * @tparam Inline Whether the permutation lives inside the container object
+     *
+     * Heap permutations are shared between copies of a container and cloned
+     * before the first write to a shared one, so a shared permutation is never
+     * modified. Inline permutations are part of the object and copied with it.
+     */
+    template<typename Indices, bool Inline>
+    class PermutationSlot {
+    private:
+        std::shared_ptr<Indices> indices; ///< Permutation, null until first needed
+
+    public:
+        PermutationSlot() = default;
+
+        template<typename IndexAlloc>
+        explicit PermutationSlot(const IndexAlloc&) {}
+
+        Indices* operator->() const { return indices.get(); }
+        Indices& operator*() const { return *indices; }
+
+        /**
+         * @brief Returns a permutation this slot alone may overwrite from scratch
+         * @param alloc Allocator for a newly created permutation
+         * Time Complexity: O(1)
+         */
+        template<typename IndexAlloc>
+        Indices& fresh(const IndexAlloc& alloc) {
+            if (!indices || indices.use_count() > 1) {
+                indices = std::allocate_shared<Indices>(alloc, alloc);
+            }
+            return *indices;
+        }
+
+        /**
+         * @brief Returns the permutation, cloning it first if it is shared
+         * @param alloc Allocator for the clone
+         * Time Complexity: O(1) if not shared, O(n) otherwise
+         */
+        template<typename IndexAlloc>
+        Indices& own(const IndexAlloc& alloc) {
+            if (indices.use_count() > 1) {
+                indices = std::allocate_shared<Indices>(alloc, *indices, alloc);
+            }
+            return *indices;
+        }
+
+        void reset() noexcept {
+            indices.reset();
+        }
+
+        size_t memory_usage() const {
+            return indices ? indices->memory_usage() : 0;
+        }
+    };
+
+    template<typename Indices>
+    class PermutationSlot<Indices, true> {
+    private:
+        mutable Indices indices; ///< Permutation, inline up to the container's inline capacity
+
+    public:
+        PermutationSlot() = default;
+
+        template<typename IndexAlloc>
+        explicit PermutationSlot(const IndexAlloc& alloc) : indices(alloc) {}
+
+        Indices* operator->() const { return &indices; }
+        Indices& operator*() const { return indices; }
+
+        template<typename IndexAlloc>
+        Indices& fresh(const IndexAlloc&) {
+            return indices;
+        }
+
+        template<typename IndexAlloc>
+        Indices& own(const IndexAlloc&) {
+            return indices;
+        }
+
+        void reset() noexcept {
+            indices.assign_identity(0);
+        }
+
+        size_t memory_usage() const {
+            return indices.memory_usage();
+        }
+    };
+}
+}
@@ -0,0 +1,255 @@
+// author: avivoz4@gmail.com
+
+/**
+ * @file ConcurrentContainer.hpp
+ * @brief Sharded append buffer that many threads fill and seal() turns into a MyContainer
+ * @author Aviv Oz
+ * @email avivoz4@gmail.com
+ *
+ * MyContainer itself is not thread-safe, and guarding every add() with one
+ * mutex serializes the producers. ConcurrentContainer instead gives each
+ * producer thread its own shard: a vector behind its own cache-line-aligned
+ * mutex. Each container assigns its shards round-robin to threads in the
+ * order they first add to it, so up to shard_count() producers of one
+ * container never contend with each other. Each shard's std::mutex is then
+ * normally uncontended; only size(), snapshot() and seal() take it from
+ * other threads. seal() detaches every shard and concatenates them into an
+ * ordinary MyContainer, on which all six iteration orders work as usual.
+ */
+
+#pragma once
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <array>
+#include <deque>
+#include <cstdint>
+#include <vector>
+#include <cstddef>
+#include <utility>
+#include <iterator>
+#include "MyContainer.hpp"
+
+namespace containers {
+
+    /**
+     * @brief Append-only container that many threads may add to concurrently
+     * @tparam T The type of elements to store
+     * @tparam Allocator Allocator for the shards and the sealed container; it
+     * is used from every producer thread, so a std::pmr resource must be a
+     * synchronized one such as std::pmr::synchronized_pool_resource
+     *
+     * add() may be called from any number of threads at once, together with
+     * size(), snapshot() and seal(). Elements added by one thread keep their
+     * relative order in the sealed container; elements of different threads
+     * are grouped by shard rather than interleaved by time.
+     */
+    template<typename T, typename Allocator = std::allocator<T>>
+    class ConcurrentContainer {
+    private:
+        using Buffer = std::vector<T, Allocator>;
+
+        /**
+         * @brief One producer's buffer, on its own cache lines
+         */
+        struct alignas(64) Shard {
+            mutable std::mutex lock; ///< Guards items
+            Buffer items;            ///< Elements added through this shard since the last seal()
+
+            explicit Shard(const Allocator& a) : items(a) {}
+        };
+
+        static constexpr size_t remembered_containers = 4; ///< Shard assignments each thread caches
+
+        Allocator alloc;                  ///< Allocator for shard buffers and sealed containers
+        size_t shard_total;               ///< Number of shards
+        std::deque<Shard> shards;         ///< Shards, fixed for the container's lifetime
+        std::atomic<size_t> next_slot{0}; ///< Shard handed to the next thread that adds
+        const uint64_t id = new_id();     ///< Never reused, unlike the container's address
+
+        /**
+         * @brief Returns a process-wide unique container id, never 0
+         * Time Complexity: O(1)
+         */
+        static uint64_t new_id() {
+            static std::atomic<uint64_t> next{1};
+            return next.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Returns the shard index this container assigned to the calling thread
+         * Time Complexity: O(1)
+         *
+         * Each thread caches its shard for the last remembered_containers
+         * containers it added to. A thread returning to a container it was
+         * evicted for is assigned the next shard again, which may be shared.
+         */
+        size_t thread_slot() {
+            struct Entry {
+                uint64_t container = 0;
+                size_t slot = 0;
+            };
+            thread_local std::array<Entry, remembered_containers> recent{};
+            thread_local size_t replace = 0;
+            for (const Entry& entry : recent) {
+                if (entry.container == id) return entry.slot;
+            }
+            size_t slot = next_slot.fetch_add(1, std::memory_order_relaxed) % shard_total;
+            recent[replace] = Entry{id, slot};
+            replace = (replace + 1) % remembered_containers;
+            return slot;
+        }
+
+        /**
+         * @brief Returns the shard the calling thread appends to
+         * Time Complexity: O(1)
+         */
+        Shard& local_shard() {
+            return shards[thread_slot()];
+        }
+
+    public:
+        /**
+         * @brief Creates an empty container
+         * @param shard_count Number of shards, 0 for one per hardware thread
+         * @param a Allocator for shard buffers and sealed containers
+         * Time Complexity: O(shards)
+         */
+        explicit ConcurrentContainer(size_t shard_count = 0, const Allocator& a = Allocator()) :
+            alloc(a),
+            shard_total(shard_count != 0 ? shard_count : execution::par.thread_count()) {
+            for (size_t i = 0; i < shard_total; ++i) {
+                shards.emplace_back(alloc);
+            }
+        }
+
+        ConcurrentContainer(const ConcurrentContainer&) = delete;
+        ConcurrentContainer& operator=(const ConcurrentContainer&) = delete;
+
+        /**
+         * @brief Adds an element from any thread
+         * @param value The value to add
+         * Time Complexity: O(1) amortized, with no contention among the first
+         * shard_count() threads to add to this container while none of them
+         * adds to more than three other containers in between
+         */
+        void add(const T& value) {
+            Shard& shard = local_shard();
+            std::lock_guard<std::mutex> guard(shard.lock);
+            shard.items.push_back(value);
+        }
+
+        /**
+         * @brief Adds an element from any thread by moving it
+         * @param value The value to move into the container
+         * Time Complexity: O(1) amortized
+         */
+        void add(T&& value) {
+            Shard& shard = local_shard();
+            std::lock_guard<std::mutex> guard(shard.lock);
+            shard.items.push_back(std::move(value));
+        }
+
+        /**
+         * @brief Constructs an element in place from any thread
+         * @param args Arguments forwarded to the constructor of T
+         * Time Complexity: O(1) amortized
+         */
+        template<typename... Args>
+        void emplace(Args&&... args) {
+            Shard& shard = local_shard();
+            std::lock_guard<std::mutex> guard(shard.lock);
+            shard.items.emplace_back(std::forward<Args>(args)...);
+        }
+
+        /**
+         * @brief Adds the elements of [first, last) from any thread under a single lock
+         * @param first Iterator to the first element
+         * @param last Iterator past the last element
+         * Time Complexity: O(m) where m is the range length
+         */
+        template<typename InputIt, typename = std::enable_if_t<detail::is_input_iterator<InputIt>::value>>
+        void append(InputIt first, InputIt last) {
+            Shard& shard = local_shard();
+            std::lock_guard<std::mutex> guard(shard.lock);
+            shard.items.insert(shard.items.end(), first, last);
+        }
+
+        /**
+         * @brief Returns the number of shards
+         * Time Complexity: O(1)
+         */
+        size_t shard_count() const {
+            return shard_total;
+        }
+
+        /**
+         * @brief Returns the number of elements added since the last seal()
+         * @return Exact when no thread is adding, otherwise a value seen at some
+         * point during the call
+         * Time Complexity: O(shards)
+         */
+        size_t size() const {
+            size_t total = 0;
+            for (size_t i = 0; i < shard_total; ++i) {
+                std::lock_guard<std::mutex> guard(shards[i].lock);
+                total += shards[i].items.size();
+            }
+            return total;
+        }
+
+        /**
+         * @brief Moves every element added so far into a new MyContainer
+         * @return Container holding the elements grouped by shard, the largest
+         * shard first, with each thread's elements in the order it added them
+         * Time Complexity: O(shards) under locks, then O(n) to concatenate
+         *
+         * Each shard is locked only long enough to detach its buffer, so
+         * producers keep adding while the rest of the work runs; elements
+         * added after their shard was detached remain for the next seal().
+         * The largest shard's buffer becomes the container's storage, so its
+         * elements are not moved unless that buffer has to grow.
+         */
+        MyContainer<T, Allocator> seal() {
+            std::vector<Buffer> detached;
+            detached.reserve(shard_total);
+            size_t total = 0;
+            size_t largest = 0;
+            for (size_t i = 0; i < shard_total; ++i) {
+                Buffer taken(alloc);
+                {
+                    std::lock_guard<std::mutex> guard(shards[i].lock);
+                    taken.swap(shards[i].items);
+                }
+                total += taken.size();
+                detached.push_back(std::move(taken));
+                if (detached[i].size() > detached[largest].size()) largest = i;
+            }
+
+            Buffer merged = std::move(detached[largest]);
+            merged.reserve(total);
+            for (size_t i = 0; i < shard_total; ++i) {
+                if (i == largest) continue;
+                merged.insert(merged.end(), std::make_move_iterator(detached[i].begin()),
+                              std::make_move_iterator(detached[i].end()));
+            }
+            return MyContainer<T, Allocator>(std::move(merged));
+        }
+
+        /**
+         * @brief Copies every element added so far into a new MyContainer
+         * @return Container holding the elements grouped by shard in shard
+         * order; this container keeps them
+         * Time Complexity: O(n), locking one shard at a time
+         */
+        MyContainer<T, Allocator> snapshot() const {
+            MyContainer<T, Allocator> result(alloc);
+            for (size_t i = 0; i < shard_total; ++i) {
+                std::lock_guard<std::mutex> guard(shards[i].lock);
+                result.append(shards[i].items.begin(), shards[i].items.end());
+            }
+            return result;
+        }
+    };
+}
@@ -0,0 +1,401 @@
+// author: avivoz4@gmail.com
+
+/**
+ * @file MappedVector.hpp
+ * @brief Element storage in a growable memory-mapped file, behind MappedContainer
+ * @author Aviv Oz
+ * @email avivoz4@gmail.com
+ *
+ * For trivially copyable element types the elements can live in a shared
+ * file mapping instead of the heap. The file starts with a small header
+ * recording the element size and count, followed by the raw elements, so a
+ * file written by one process is reopened by the next without any parsing:
+ * the mapping is the container. Growth extends the file with ftruncate and
+ * the mapping with mremap (munmap and mmap where mremap is unavailable).
+ * Without a file the same code runs over an anonymous mapping.
+ */
+
+#pragma once
+#include <memory>
+#include <cerrno>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <iterator>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+#include <system_error>
+#include <initializer_list>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace containers {
+namespace detail {
+
+    /**
+     * @brief Contiguous sequence of trivially copyable elements in a memory mapping
+     * @tparam T Element type, trivially copyable and aligned to at most 64 bytes
+     *
+     * Only the subset of the std::vector interface that MyContainer uses is
+     * provided, and iterators are plain pointers into the mapping. Growing
+     * may move the mapping, so element addresses are stable only between
+     * growths, as with std::vector.
+     */
+    template<typename T>
+    class MappedVector {
+        static_assert(std::is_trivially_copyable<T>::value, "MappedVector needs a trivially copyable T");
+        static_assert(alignof(T) <= 64, "MappedVector places elements at a 64-byte offset");
+
+    public:
+        using value_type = T;
+        using allocator_type = std::allocator<T>;
+        using size_type = size_t;
+        using difference_type = std::ptrdiff_t;
+        using reference = T&;
+        using const_reference = const T&;
+        using iterator = T*;
+        using const_iterator = const T*;
+
+    private:
+        /**
+         * @brief Layout of the first 64 bytes of the mapping
+         */
+        struct Header {
+            char magic[8];          ///< "MYCONT1" followed by a zero byte
+            uint64_t element_size;  ///< sizeof(T) of the writer
+            uint64_t count;         ///< Number of live elements
+            char reserved[40];      ///< Pads the header to 64 bytes
+        };
+        static_assert(sizeof(Header) == 64, "Header must stay 64 bytes");
+
+        static constexpr char file_magic[8] = {'M', 'Y', 'C', 'O', 'N', 'T', '1', '\0'};
+        static constexpr size_t min_bytes = 4096; ///< Smallest mapping, one page on most systems
+
+        int fd = -1;             ///< Backing file, or -1 for an anonymous mapping
+        void* base = nullptr;    ///< Start of the mapping, null before the first element
+        size_t mapped = 0;       ///< Length of the mapping in bytes
+        bool private_copy = false; ///< Whether the mapping is a copy-on-write view of a file
+
+        Header* header() const { return static_cast<Header*>(base); }
+        T* data() const { return base ? reinterpret_cast<T*>(static_cast<char*>(base) + sizeof(Header)) : nullptr; }
+
+        [[noreturn]] static void fail(const char* what) {
+            throw std::system_error(errno, std::generic_category(), what);
+        }
+
+        /**
+         * @brief Maps bytes of the file, or of anonymous memory
+         * @param bytes Length of the mapping
+         * @return Address of the new mapping
+         */
+        void* map(size_t bytes) const {
+            void* p = fd >= 0
+                ? ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)
+                : ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (p == MAP_FAILED) fail("mmap");
+            return p;
+        }
+
+        /**
+         * @brief Grows the mapping to at least bytes, extending the file first
+         * @param bytes New minimum length
+         * Time Complexity: O(1) page-table work with mremap; O(n) copy for anonymous
+         * mappings on systems without it
+         */
+        void remap(size_t bytes) {
+            if (fd >= 0 && ::ftruncate(fd, static_cast<off_t>(bytes)) != 0) fail("ftruncate");
+            if (!base) {
+                base = map(bytes);
+                mapped = bytes;
+                std::memcpy(header()->magic, file_magic, sizeof(file_magic));
+                header()->element_size = sizeof(T);
+                header()->count = 0;
+                return;
+            }
+#ifdef MREMAP_MAYMOVE
+            if (!private_copy) {
+                void* p = ::mremap(base, mapped, bytes, MREMAP_MAYMOVE);
+                if (p == MAP_FAILED) fail("mremap");
+                base = p;
+                mapped = bytes;
+                return;
+            }
+#endif
+            // A private file view cannot grow past the end of the file, so it
+            // moves to anonymous memory on its first growth
+            void* p = map(bytes);
+            if (fd < 0) std::memcpy(p, base, mapped);
+            ::munmap(base, mapped);
+            base = p;
+            mapped = bytes;
+            private_copy = false;
+        }
+
+        /**
+         * @brief Unmaps and closes the file, trimming it to the live elements
+         */
+        void release() noexcept {
+            size_t used = base ? sizeof(Header) + size() * sizeof(T) : 0;
+            if (base) ::munmap(base, mapped);
+            if (fd >= 0) {
+                // If trimming fails the file keeps its spare capacity; the header still holds the count
+                int trimmed = used != 0 ? ::ftruncate(fd, static_cast<off_t>(used)) : 0;
+                static_cast<void>(trimmed);
+                ::close(fd);
+            }
+            fd = -1;
+            base = nullptr;
+            mapped = 0;
+            private_copy = false;
+        }
+
+        /**
+         * @brief Grows the mapping geometrically until n elements fit
+         * @param n Number of elements
+         */
+        void grow_for(size_t n) {
+            if (n > capacity()) {
+                size_t bytes = std::max(min_bytes, mapped * 2);
+                while (bytes < sizeof(Header) + n * sizeof(T)) bytes *= 2;
+                remap(bytes);
+            }
+        }
+
+    public:
+        /**
+         * @brief Creates an empty vector over anonymous memory
+         */
+        MappedVector() noexcept = default;
+
+        explicit MappedVector(const allocator_type&) noexcept {}
+
+        /**
+         * @brief Opens or creates a file holding the elements
+         * @param path File to map; created when missing
+         * @throws std::system_error if the file cannot be opened or mapped
+         * @throws std::runtime_error if the file holds elements of a different size
+         * Time Complexity: O(1), pages are loaded as they are touched
+         */
+        explicit MappedVector(const std::string& path) {
+            fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+            if (fd < 0) fail("open");
+            struct stat info;
+            if (::fstat(fd, &info) != 0) {
+                int saved = errno;
+                ::close(fd);
+                errno = saved;
+                fail("fstat");
+            }
+            size_t bytes = static_cast<size_t>(info.st_size);
+            if (bytes == 0) return;
+            try {
+                if (bytes < sizeof(Header)) {
+                    throw std::runtime_error("File is not a MyContainer mapping");
+                }
+                base = map(bytes);
+                mapped = bytes;
+                if (std::memcmp(header()->magic, file_magic, sizeof(file_magic)) != 0) {
+                    throw std::runtime_error("File is not a MyContainer mapping");
+                }
+                if (header()->element_size != sizeof(T)) {
+                    throw std::runtime_error("File holds elements of a different size");
+                }
+                if (header()->count > (bytes - sizeof(Header)) / sizeof(T)) {
+                    throw std::runtime_error("File is shorter than its element count");
+                }
+            } catch (...) {
+                if (base) ::munmap(base, mapped);
+                ::close(fd);
+                throw;
+            }
+        }
+
+        /**
+         * @brief Maps count elements stored after a 64-byte header, copy-on-write
+         * @param file Open file descriptor; not retained
+         * @param count Number of elements following the header
+         * @return Vector whose elements are the file's pages, shared until written
+         * @throws std::system_error if the file cannot be mapped
+         * Time Complexity: O(1), pages are read as they are first touched
+         *
+         * The file's header is replaced by this vector's own in the private
+         * mapping, which copies only the first page. Changes never reach the
+         * file, and the first growth moves the elements to anonymous memory.
+         */
+        static MappedVector adopt_private(int file, size_t count) {
+            MappedVector result;
+            if (count == 0) return result;
+            size_t bytes = sizeof(Header) + count * sizeof(T);
+            void* p = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE, file, 0);
+            if (p == MAP_FAILED) fail("mmap");
+            result.base = p;
+            result.mapped = bytes;
+            result.private_copy = true;
+            std::memcpy(result.header()->magic, file_magic, sizeof(file_magic));
+            result.header()->element_size = sizeof(T);
+            result.header()->count = count;
+            return result;
+        }
+
+        template<typename InputIt, typename = std::enable_if_t<std::is_convertible<
+            typename std::iterator_traits<InputIt>::iterator_category, std::input_iterator_tag>::value>>
+        MappedVector(InputIt first, InputIt last, const allocator_type& = allocator_type()) {
+            insert(end(), first, last);
+        }
+
+        MappedVector(std::initializer_list<T> values, const allocator_type& a = allocator_type()) :
+            MappedVector(values.begin(), values.end(), a) {}
+
+        /**
+         * @brief Copies the elements into a new anonymous mapping
+         */
+        MappedVector(const MappedVector& other, const allocator_type& a = allocator_type()) :
+            MappedVector(other.begin(), other.end(), a) {}
+
+        MappedVector(MappedVector&& other) noexcept :
+            fd(std::exchange(other.fd, -1)),
+            base(std::exchange(other.base, nullptr)),
+            mapped(std::exchange(other.mapped, 0)),
+            private_copy(std::exchange(other.private_copy, false)) {}
+
+        MappedVector& operator=(const MappedVector& other) {
+            if (this != &other) {
+                clear();
+                insert(end(), other.begin(), other.end());
+            }
+            return *this;
+        }
+
+        MappedVector& operator=(MappedVector&& other) noexcept {
+            if (this != &other) {
+                release();
+                fd = std::exchange(other.fd, -1);
+                base = std::exchange(other.base, nullptr);
+                mapped = std::exchange(other.mapped, 0);
+                private_copy = std::exchange(other.private_copy, false);
+            }
+            return *this;
+        }
+
+        ~MappedVector() {
+            release();
+        }
+
+        allocator_type get_allocator() const { return allocator_type(); }
+
+        iterator begin() noexcept { return data(); }
+        iterator end() noexcept { return data() + size(); }
+        const_iterator begin() const noexcept { return data(); }
+        const_iterator end() const noexcept { return data() + size(); }
+
+        size_t size() const noexcept { return base ? static_cast<size_t>(header()->count) : 0; }
+        bool empty() const noexcept { return size() == 0; }
+
+        /**
+         * @brief Number of elements that fit in the current mapping
+         * Time Complexity: O(1)
+         */
+        size_t capacity() const noexcept { return base ? (mapped - sizeof(Header)) / sizeof(T) : 0; }
+
+        /**
+         * @brief Whether the elements live in a file
+         * Time Complexity: O(1)
+         */
+        bool is_file_backed() const noexcept { return fd >= 0; }
+
+        /**
+         * @brief Flushes the mapped elements to the file
+         * @throws std::system_error if msync fails
+         * Time Complexity: O(dirty pages)
+         */
+        void sync() const {
+            if (fd >= 0 && base && ::msync(base, mapped, MS_SYNC) != 0) fail("msync");
+        }
+
+        T& operator[](size_t i) { return data()[i]; }
+        const T& operator[](size_t i) const { return data()[i]; }
+        T& back() { return data()[size() - 1]; }
+        const T& back() const { return data()[size() - 1]; }
+
+        /**
+         * @brief Grows the mapping, and the file, until n elements fit
+         * Time Complexity: O(1) with mremap
+         */
+        void reserve(size_t n) {
+            grow_for(n);
+        }
+
+        /**
+         * @brief Constructs an element at the back
+         * @return Reference to the new element
+         * Time Complexity: O(1) amortized
+         */
+        template<typename... Args>
+        T& emplace_back(Args&&... args) {
+            T value(std::forward<Args>(args)...);
+            grow_for(size() + 1);
+            T* slot = data() + size();
+            std::memcpy(static_cast<void*>(slot), &value, sizeof(T));
+            ++header()->count;
+            return *slot;
+        }
+
+        void push_back(const T& value) { emplace_back(value); }
+
+        void pop_back() {
+            --header()->count;
+        }
+
+        void clear() noexcept {
+            if (base) header()->count = 0;
+        }
+
+        /**
+         * @brief Inserts the elements of [first, last) before pos
+         * @return Iterator to the first inserted element
+         * Time Complexity: O(m) at the back, O(n + m) elsewhere
+         */
+        template<typename InputIt>
+        iterator insert(const_iterator pos, InputIt first, InputIt last) {
+            size_t offset = static_cast<size_t>(pos - begin());
+            size_t old_size = size();
+            if constexpr (std::is_convertible<typename std::iterator_traits<InputIt>::iterator_category,
+                                              std::forward_iterator_tag>::value) {
+                grow_for(old_size + static_cast<size_t>(std::distance(first, last)));
+            }
+            for (; first != last; ++first) {
+                emplace_back(*first);
+            }
+            std::rotate(begin() + offset, begin() + old_size, end());
+            return begin() + offset;
+        }
+
+        iterator erase(const_iterator pos) {
+            return erase(pos, pos + 1);
+        }
+
+        /**
+         * @brief Erases the elements in [first, last)
+         * @return Iterator to the element that followed them
+         * Time Complexity: O(n)
+         */
+        iterator erase(const_iterator first, const_iterator last) {
+            T* target = begin() + (first - begin());
+            size_t removed = static_cast<size_t>(last - first);
+            std::move(target + removed, end(), target);
+            header()->count -= removed;
+            return target;
+        }
+    };
+
+    template<typename T>
+    size_t heap_bytes(const MappedVector<T>& storage) {
+        return storage.capacity() * sizeof(T);
+    }
+}
+}
@@ -22,643 +22,1606 @@
 #include <algorithm>
 #include <stdexcept>
 #include <ostream>
+#include <locale>
+#include <utility>
+#include <iterator>
+#include <type_traits>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <memory>
+#include <memory_resource>
+#include <limits>
+#include <cstddef>
+#include <cstdio>
+#include <cerrno>
+#include <system_error>
+#include "RadixSort.hpp"
+#include "ParallelSort.hpp"
+#include "CacheLock.hpp"
+#include "ValueIndex.hpp"
+#include "SortedBlocks.hpp"
+#include "CompactIndices.hpp"
+#include "SmallVector.hpp"
+#include "SegmentedVector.hpp"
+#include "TextFormat.hpp"
+#if __has_include(<sys/mman.h>)
+#include "MappedVector.hpp"
+#endif
+#if __has_include(<sys/uio.h>)
+#include <fcntl.h>
+#include "BinaryFormat.hpp"
+#endif
 
 namespace containers {
 
+    namespace detail {
+        /**
+         * @brief Whether It is usable as an input iterator
+         */
+        template<typename It, typename = void>
+        struct is_input_iterator : std::false_type {};
+
+        template<typename It>
+        struct is_input_iterator<It, std::enable_if_t<std::is_convertible<
+            typename std::iterator_traits<It>::iterator_category,
+            std::input_iterator_tag>::value>> : std::true_type {};
+
+        /**
+         * @brief Whether R can be traversed with std::begin and std::end
+         */
+        template<typename R, typename = void>
+        struct is_range : std::false_type {};
+
+        template<typename R>
+        struct is_range<R, std::void_t<
+            decltype(std::begin(std::declval<R&>())),
+            decltype(std::end(std::declval<R&>()))>> : std::true_type {};
+
+        /**
+         * @brief Heap memory held by a std::vector's elements
+         * @return Bytes of allocated capacity
+         * Time Complexity: O(1)
+         */
+        template<typename T, typename Alloc>
+        size_t heap_bytes(const std::vector<T, Alloc>& storage) {
+            return storage.capacity() * sizeof(T);
+        }
+
+        /**
+         * @brief Whether a storage keeps its elements in one contiguous block
+         */
+        template<typename Storage>
+        struct is_contiguous_storage : std::is_pointer<typename Storage::iterator> {};
+
+        template<typename T, typename Alloc>
+        struct is_contiguous_storage<std::vector<T, Alloc>> : std::true_type {};
+
+        /**
+         * @brief Whether operator[] and iterator dereference check their bounds
+         *
+         * Checked by default. Defining CONTAINERS_UNCHECKED before including
+         * this header turns both into plain loads, like std::vector::operator[],
+         * while at() stays checked.
+         *
+         * The setting must be the same in every translation unit of a program,
+         * so pass it on the compiler command line (-DCONTAINERS_UNCHECKED), not
+         * in a source file. operator[], the iterators and every inline function
+         * that calls them are compiled into each translation unit, and the
+         * linker keeps one copy of each, so mixing settings violates the one
+         * definition rule and leaves it unspecified which behaviour runs.
+         */
+#ifdef CONTAINERS_UNCHECKED
+        inline constexpr bool checked_access = false;
+#else
+        inline constexpr bool checked_access = true;
+#endif
+    }
+
+    /**
+     * @brief Strategy used to build the sorted permutation behind sorted views
+     *
+     * Full sorts every index on the first sorted access after a mutation.
+     * Incremental places ranks in growing chunks from whichever end is read,
+     * which is cheaper when consumers stop after the first few elements.
+     * Maintained keeps an order-statistics structure that add and remove
+     * update in O(log n + B) amortized for blocks of B = 256 positions, so
+     * interleaved reads never wait for a sort.
+     */
+    enum class SortMode {
+        Full,
+        Incremental,
+        Maintained
+    };
+
     /**
      * @brief Generic container class for comparable types
      * @tparam T The type of elements to store (must be comparable)
+     * @tparam Allocator Allocator for the elements; the sorted permutation, the
+     * maintained order and sorting scratch buffers use it too, rebound to their
+     * own types. The optional hash index uses the global heap.
+     * @tparam Storage Sequence holding the elements: std::vector by default,
+     * detail::SmallVector for SmallContainer, detail::SegmentedVector for
+     * SegmentedContainer or detail::MappedVector for MappedContainer. Storages with inline capacity keep permutations up to
+     * that size inline as well.
      * 
      * This container provides efficient storage and multiple iteration patterns
      * for any type that supports comparison operations (<, >, ==).
      * All iterators maintain const-correctness and provide STL-compatible interfaces.
      */
-    template<typename T>
+    template<typename T, typename Allocator = std::allocator<T>, typename Storage = std::vector<T, Allocator>>
     class MyContainer {
-    private:
-        std::vector<T> elements;  ///< Internal storage for elements
+        static_assert(std::is_same<typename Storage::value_type, T>::value,
+                      "Storage must hold elements of type T");
+        static_assert(std::is_same<typename Storage::allocator_type, Allocator>::value,
+                      "Storage must use Allocator");
 
     public:
+        using allocator_type = Allocator; ///< Allocator used for elements and internal buffers
+
+    private:
+        using IndexAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<size_t>;
+        static constexpr size_t inline_size = detail::inline_capacity<Storage>::value;
+        using Indices = detail::CompactIndices<IndexAllocator, inline_size>;
+        using Permutation = detail::PermutationSlot<Indices, (inline_size > 0)>;
+        using Tree = detail::SortedBlocks<IndexAllocator>;
+
+        Storage elements;                   ///< Internal storage for elements
+        size_t version = 0;                 ///< Mutation counter, bumped by every modifying operation
+
+        SortMode mode = SortMode::Full;           ///< How the sorted permutation is built
+        mutable detail::ValueIndex<T> value_index; ///< Optional hash index for value lookups
+
+        /// Element indices, ascending by value once sorted. Heap permutations are shared
+        /// by copies of the container until one of them has to write.
+        mutable Permutation sorted_cache;
+        mutable size_t sorted_front = 0;          ///< Ranks [0, sorted_front) are in final position
+        mutable size_t sorted_back = 0;           ///< The last sorted_back ranks are in final position
+        mutable size_t sorted_version = 0;        ///< Value of version when sorted_cache was reset
+        mutable bool sorted_valid = false;        ///< Whether sorted_cache has been reset at all
+
+        mutable Tree sorted_tree;                 ///< Sorted positions kept up to date in Maintained mode
+        mutable bool tree_valid = false;          ///< Whether sorted_tree matches the elements
+
+        /// Guards the caches above while const member functions build them, so
+        /// several threads may read one unmodified container at once
+        mutable detail::CacheLock cache_lock;
+
+        static constexpr size_t incremental_min_chunk = 64;  ///< Smallest range sorted per extension
+        static constexpr size_t radix_min_size = 512;        ///< Smallest full sort handed to radix sort
+        static constexpr size_t parallel_min_chunk = 16384;  ///< Fewest indices worth a sorting thread
+        static constexpr size_t text_block_size = 1 << 20;   ///< Bytes read_from parses per block
+
         /**
-         * @brief Default constructor
-         * Creates an empty container
+         * @brief Allocator for index buffers, drawing from the same memory as the elements
          * Time Complexity: O(1)
          */
-        MyContainer() = default;
+        IndexAllocator index_allocator() const {
+            return IndexAllocator(elements.get_allocator());
+        }
 
         /**
-         * @brief Copy constructor
-         * @param other Container to copy from
-         * Time Complexity: O(n) where n is the size of other
+         * @brief Takes over or shares the sorted permutation and maintained order of another container
+         * @param other Container whose elements this one now holds
+         * @param move Whether other's structures may be moved from
+         * Time Complexity: O(1) to share, O(n) to copy the maintained order
+         *
+         * The permutation is only shared when both containers allocate from the
+         * same memory; otherwise this container would keep memory of the other's
+         * allocator alive, so it drops the permutation and sorts again on demand.
          */
-        MyContainer(const MyContainer& other) = default;
+        void adopt_sorted(const MyContainer& other, bool move) {
+            std::lock_guard<detail::CacheLock> guard(other.cache_lock);
+            cache_lock.forget();
+            if (other.sorted_valid && index_allocator() == other.index_allocator()) {
+                sorted_cache = move ? std::move(other.sorted_cache) : other.sorted_cache;
+                sorted_front = other.sorted_front;
+                sorted_back = other.sorted_back;
+                sorted_version = other.sorted_version;
+                sorted_valid = true;
+            } else {
+                sorted_cache.reset();
+                sorted_front = 0;
+                sorted_back = 0;
+                sorted_valid = false;
+            }
+            if (other.tree_valid) {
+                if (move) {
+                    sorted_tree = std::move(other.sorted_tree);
+                } else {
+                    sorted_tree = other.sorted_tree;
+                }
+                tree_valid = true;
+            } else {
+                sorted_tree.clear();
+                tree_valid = false;
+            }
+        }
 
         /**
-         * @brief Assignment operator
-         * @param other Container to assign from
-         * @return Reference to this container
-         * Time Complexity: O(n) where n is the size of other
+         * @brief Appends every element of a range, moving them out of rvalue ranges
+         * @param range Range usable with std::begin/std::end
+         * Time Complexity: O(m) where m is the range length
          */
-        MyContainer& operator=(const MyContainer& other) = default;
+        template<typename Range>
+        void append_range(Range&& range) {
+            auto first = std::begin(range);
+            auto last = std::end(range);
+            if constexpr (std::is_rvalue_reference<Range&&>::value &&
+                          !std::is_const<std::remove_reference_t<Range>>::value) {
+                append(std::make_move_iterator(first), std::make_move_iterator(last));
+            } else {
+                append(first, last);
+            }
+        }
 
+#if __has_include(<sys/uio.h>)
         /**
-         * @brief Adds a new element to the container
-         * @param value The value to add
-         * Time Complexity: O(1) amortized
+         * @brief Reads a payload described by header into the empty element storage
+         * @param fd File descriptor positioned after the header
+         * @param header Header already checked against T
+         * @throws std::runtime_error if the payload is truncated, malformed or fails its checksum
+         * Time Complexity: O(n)
+         *
+         * A std::vector is read into directly; other storages are filled from
+         * a bounded staging buffer. Memory is reserved up front only when fd
+         * is a regular file long enough for the payload, so a corrupt header
+         * read from a pipe fails at the end of input rather than allocating
+         * what the header claims.
          */
-        void add(const T& value) {
-            elements.push_back(value);
+        void read_payload(int fd, const detail::BinaryHeader& header) {
+            detail::Checksum checksum;
+            size_t count = static_cast<size_t>(header.count);
+            const bool verified = detail::check_available(fd, header.payload_bytes);
+            if constexpr (std::is_trivially_copyable<T>::value) {
+                if constexpr (std::is_same<Storage, std::vector<T, Allocator>>::value) {
+                    detail::read_values(fd, elements, count, verified, checksum);
+                } else {
+                    if (verified) elements.reserve(count);
+                    std::vector<T> staging(std::min<size_t>(count, 4096));
+                    for (size_t done = 0; done < count; done += staging.size()) {
+                        size_t n = std::min(staging.size(), count - done);
+                        detail::read_exact(fd, staging.data(), n * sizeof(T));
+                        checksum.update(staging.data(), n * sizeof(T));
+                        elements.insert(elements.end(), staging.begin(), staging.begin() + n);
+                    }
+                }
+            } else {
+                std::vector<char> payload;
+                detail::read_values(fd, payload, static_cast<size_t>(header.payload_bytes), verified, checksum);
+                elements.reserve(count);
+                detail::decode_strings(payload.data(), payload.data() + payload.size(), count,
+                    [this](const char* data, size_t length) { elements.emplace_back(data, length); });
+            }
+            if (checksum.value() != header.checksum) {
+                throw std::runtime_error("Checksum mismatch");
+            }
+            ++version;
         }
+#endif
 
         /**
-         * @brief Removes the first occurrence of an element
-         * @param value The value to remove
-         * @throws std::runtime_error if the element is not found
-         * Time Complexity: O(n) where n is the container size
+         * @brief Formats the elements of a view as [elem1,elem2,...,elemN] into a sink
+         * @param view Any of the six orders of this container
+         * @param sink Callable taking (const char* data, size_t size), called per 64 KiB chunk
+         * @param precision Significant digits for floating point values
+         * Time Complexity: O(n)
          */
-        void remove(const T& value) {
-            auto it = std::find(elements.begin(), elements.end(), value);
-            if (it == elements.end()) {
-                throw std::runtime_error("Element not found");
+        template<typename View, typename Sink>
+        void write_text(const View& view, Sink& sink, int precision) const {
+            detail::TextWriter<Sink> writer(sink, precision);
+            writer.put('[');
+            bool first = true;
+            for (const T& element : view) {
+                if (!first) writer.put(',');
+                writer.put_value(element);
+                first = false;
             }
-            elements.erase(it);
+            writer.put(']');
+            writer.flush();
         }
 
         /**
-         * @brief Returns the current size of the container
-         * @return Number of elements in the container
-         * Time Complexity: O(1)
+         * @brief Returns the hash index, first rebuilding it if it went stale
+         * Time Complexity: O(1), O(n) expected after elements were handed out by reference
          */
-        size_t size() const {
-            return elements.size();
+        const detail::ValueIndex<T>& fresh_index() const {
+            if (value_index.stale()) {
+                std::lock_guard<detail::CacheLock> guard(cache_lock);
+                value_index.refresh(elements);
+            }
+            return value_index;
         }
 
         /**
-         * @brief Access operator for the container
-         * @param index The index to access
-         * @return Reference to the element at the specified index
-         * @throws std::out_of_range if index is invalid
-         * Time Complexity: O(1)
+         * @brief Copies the hash index while no other reader is rebuilding it
+         * Time Complexity: O(n) while the index is enabled, O(1) otherwise
          */
-
-        T& operator[](size_t index) {
-            if (index >= elements.size()) {
-                throw std::out_of_range("Index out of bounds");
-            }
-            return elements[index];
+        detail::ValueIndex<T> copy_index() const {
+            std::lock_guard<detail::CacheLock> guard(cache_lock);
+            return value_index;
         }
 
         /**
-         * @brief Const access operator for the container
-         * @param index The index to access
-         * @return Const reference to the element at the specified index
-         * @throws std::out_of_range if index is invalid
-         * Time Complexity: O(1)
+         * @brief Finds the first occurrence of a value
+         * @param value The value to look for
+         * @return Position of the first element equal to value
+         * @throws std::runtime_error if the element is not found
+         * Time Complexity: O(log n) expected with the hash index, O(n) otherwise
          */
-        const T& operator[](size_t index) const {
-            if (index >= elements.size()) {
-                throw std::out_of_range("Index out of bounds");
+        size_t find_position(const T& value) const {
+            if (value_index.enabled()) {
+                size_t position = fresh_index().find(value);
+                if (position == detail::ValueIndex<T>::npos) {
+                    throw std::runtime_error("Element not found");
+                }
+                return position;
             }
-            return elements[index];
+            auto it = std::find(elements.begin(), elements.end(), value);
+            if (it == elements.end()) {
+                throw std::runtime_error("Element not found");
+            }
+            return static_cast<size_t>(it - elements.begin());
         }
 
         /**
-         * @brief Output stream operator
-         * @param os Output stream
-         * @param container Container to output
-         * @return Reference to the output stream
+         * @brief Erases every element matching a predicate in one pass
+         * @param pred Callable taking const T& and returning true for elements to remove
+         * @return Number of elements removed
          * Time Complexity: O(n)
-         * 
-         * Formats the container as [elem1,elem2,...,elemN]
+         *
+         * The version counter and the hash index are invalidated once for the
+         * whole batch rather than once per removed element.
          */
-        friend std::ostream& operator<<(std::ostream& os, const MyContainer& container) {
-            os << "[";
-            for (size_t i = 0; i < container.size(); ++i) {
-                os << container[i];
-                if (i < container.size() - 1) os << ",";
+        template<typename Predicate>
+        size_t compact(Predicate pred) {
+            auto new_end = std::remove_if(elements.begin(), elements.end(),
+                [&pred](const T& element) { return pred(element); });
+            size_t removed = static_cast<size_t>(elements.end() - new_end);
+            if (removed != 0) {
+                elements.erase(new_end, elements.end());
+                value_index.invalidate();
+                tree_invalidate();
+                ++version;
             }
-            os << "]";
-            return os;
+            return removed;
         }
 
-        // Iterator Classes
+        /**
+         * @brief Leaves a moved-from container empty with no cached permutation
+         * Time Complexity: O(1)
+         */
+        void reset_moved_from() noexcept {
+            elements.clear();
+            sorted_cache.reset();
+            sorted_front = 0;
+            sorted_back = 0;
+            sorted_valid = false;
+            sorted_tree.clear();
+            tree_valid = false;
+            value_index.disable();
+            ++version;
+        }
 
         /**
-         * @brief Regular order iterator
-         * Iterates through elements in their original insertion order
-         * Example: For container [1,4,2,3], iteration order is 1,4,2,3
-         * 
-         * This iterator maintains the order in which elements were added to the container.
-         * All iterator operations are const and will not modify the container.
-         * Time Complexity: O(1) for all operations
+         * @brief Strict ordering of element indices used by all sorted views
+         * @return true if element i1 sorts before element i2, ties broken by position
+         * Time Complexity: O(1) comparisons of T
          */
-        class Order {
-        private:
-            const MyContainer* container; ///< Pointer to the container being iterated
-            size_t current;              ///< Current position in the container
-            bool is_end;                 ///< Flag indicating if iterator is at end position
+        bool sorted_before(size_t i1, size_t i2) const {
+            if (elements[i1] < elements[i2]) return true;
+            if (elements[i2] < elements[i1]) return false;
+            return i1 < i2;
+        }
 
-        public:
-            /**
-             * @brief Constructor
-             * @param c Pointer to the container to iterate over
-             * @param end If true, creates an end iterator
-             * Time Complexity: O(1)
-             */
-            explicit Order(const MyContainer* c, bool end = false) : 
-                    container(c), 
-                    current(end || c->size() == 0 ? c->size() : 0),
-                    is_end(end || c->size() == 0) {}
+        /**
+         * @brief Resets the sorted permutation to index order with no rank placed
+         * Time Complexity: O(n)
+         *
+         * A permutation still shared with a copy of the container is left to
+         * the copy and a new one is allocated.
+         */
+        void reset_sorted() const {
+            sorted_cache.fresh(index_allocator()).assign_identity(elements.size());
+            sorted_front = 0;
+            sorted_back = 0;
+            sorted_version = version;
+            sorted_valid = true;
+        }
 
-            /**
-             * @brief Copy constructor
-             * @param other Iterator to copy from
-             * Time Complexity: O(1) for primitive types copy
-             */
-            Order(const Order& other) = default;
+        /**
+         * @brief Gives this container its own copy of a shared sorted permutation
+         * @return The permutation, safe to modify
+         * Time Complexity: O(1) if not shared, O(n) otherwise
+         */
+        Indices& own_sorted() const {
+            return sorted_cache.own(index_allocator());
+        }
 
-            /**
-             * @brief Assignment operator
-             * @param other Iterator to assign from
-             * @return Reference to this iterator
-             * Time Complexity: O(1)
-             */
-            Order& operator=(const Order& other) {
-                if (this != &other) {
-                    container = other.container;
-                    current = other.current;
-                    is_end = other.is_end;
+        /**
+         * @brief Sorts a range of indices that is still in ascending index order
+         * @param first Iterator to the first index
+         * @param last Iterator past the last index
+         * Time Complexity: O(m log m) where m is the range size, O(m) for arithmetic T
+         *
+         * Because the input is in index order, a stable radix sort breaks ties
+         * by position exactly like the comparison sort does.
+         */
+        template<typename IndexIt>
+        void sort_fresh(IndexIt first, IndexIt last) const {
+            if constexpr (detail::is_radix_sortable<T>::value) {
+                if (static_cast<size_t>(last - first) >= radix_min_size) {
+                    detail::radix_sort_indices<detail::radix_key_t<T>>(first, last,
+                        [this](size_t i) { return detail::radix_key(elements[i]); }, index_allocator());
+                    return;
                 }
-                return *this;
             }
+            std::sort(first, last, [this](size_t i1, size_t i2) { return sorted_before(i1, i2); });
+        }
 
-            /**
-             * @brief Equality comparison operator
-             * @param other Iterator to compare with
-             * @return true if iterators are at the same position or both at end
-             * Time Complexity: O(1)
-             */
-            bool operator==(const Order& other) const {
-                if (is_end && other.is_end) return true;
-                if (is_end || other.is_end) return false;
-                return current == other.current;
-            }     
-
-            /**
-             * @brief Inequality comparison operator
-             * @param other Iterator to compare with
-             * @return true if iterators are not at the same position
-             * Time Complexity: O(1)
-             */
-            bool operator!=(const Order& other) const {
-                return !(*this == other);
+        /**
+         * @brief Places every rank of the sorted permutation using several threads
+         * @param policy Parallel execution policy giving the thread count
+         * Time Complexity: O((n / p) log(n / p) + (n / p) log p) with p threads,
+         * O(1) if the permutation is already fully sorted
+         *
+         * Each thread sorts one slice of the index range and the slices are then
+         * merged pairwise, every thread taking a share of each merge round.
+         * Slices smaller than parallel_min_chunk are not worth a thread, so small
+         * containers are sorted on the calling thread. If a comparison throws,
+         * the permutation is dropped and the exception reaches the caller.
+         */
+        void sort_all(const execution::parallel_policy& policy) const {
+            if (cache_lock.ready(version)) return;
+            std::lock_guard<detail::CacheLock> guard(cache_lock);
+            if (tree_valid) {
+                cache_lock.mark_ready(version);
+                return;
             }
-
-            /**
-             * @brief Dereference operator
-             * @return Const reference to the current element
-             * @throws std::out_of_range if iterator is at end or invalid position
-             * Time Complexity: O(1)
-             */
-            const T& operator*() const {
-                 if (is_end || current >= container->size()) {
-                    throw std::out_of_range("Iterator out of bounds");
-                }
-                return (*container)[current];
+            if (!sorted_valid || sorted_version != version || sorted_front != sorted_cache->size()) {
+                reset_sorted();
+                // No longer in index order if a comparison throws part way
+                sorted_valid = false;
+
+                size_t n = sorted_cache->size();
+                unsigned threads = static_cast<unsigned>(
+                    std::min<size_t>(policy.thread_count(), n / parallel_min_chunk));
+                sorted_cache->visit([this, threads](auto first, auto last) {
+                    detail::parallel_sort(first, last,
+                        [this](size_t i1, size_t i2) { return sorted_before(i1, i2); },
+                        [this](auto chunk_first, auto chunk_last) { sort_fresh(chunk_first, chunk_last); },
+                        threads, index_allocator());
+                });
+                sorted_front = n;
+                sorted_back = 0;
+                sorted_valid = true;
             }
-        
-            /**
-             * @brief Pre-increment operator
-             * @return Reference to this iterator after incrementing
-             * Time Complexity: O(1)
-             * 
-             * If already at end, remains at end.
-             * If increment would go past end, moves to end position.
-             */
-            Order& operator++() {
-                if (!is_end) {
-                    ++current;
-                    if (current >= container->size()) {
-                        is_end = true;
-                        current = container->size();
-                    }
-                }
-                return *this;
+            if (mode == SortMode::Maintained) {
+                adopt_into_tree();
             }
+            cache_lock.mark_ready(version);
+        }
 
-            /**
-             * @brief Post-increment operator
-             * @return Copy of iterator before incrementing
-             * Time Complexity: O(1)
-             */
-            Order operator++(int) {
-                Order temp = *this;
-                ++(*this);
-                return temp;
-            }
+        /**
+         * @brief Ordering handed to sorted_tree, the same one all sorted views use
+         * @return Callable comparing two element positions
+         */
+        auto tree_order() const {
+            return [this](size_t i1, size_t i2) { return sorted_before(i1, i2); };
+        }
 
-            /**
-             * @brief Get iterator to the beginning
-             * @return Iterator pointing to the first element
-             * Time Complexity: O(1)
-             */
-            Order begin() const {
-                return Order(container, false);
-            }
+        /**
+         * @brief Moves the fully sorted permutation into sorted_tree
+         * Time Complexity: O(n)
+         */
+        void adopt_into_tree() const {
+            sorted_cache->visit([this](auto first, auto last) { sorted_tree.assign(first, last); });
+            sorted_cache.reset();
+            sorted_valid = false;
+            tree_valid = true;
+        }
 
-            /**
-             * @brief Get iterator to the end
-             * @return Iterator pointing one past the last element
-             * Time Complexity: O(1)
-             */
-            Order end() const {
-                return Order(container, true);
+        /**
+         * @brief Builds sorted_tree from a full sort of the permutation
+         * Time Complexity: O(n log n), O(n) if the permutation is already sorted
+         */
+        void build_tree() const {
+            if (!sorted_valid || sorted_version != version) {
+                reset_sorted();
             }
-        };
+            if (sorted_front + sorted_back < sorted_cache->size()) {
+                extend_sorted(sorted_front);
+            }
+            adopt_into_tree();
+        }
 
         /**
-         * @brief Reverse order iterator
-         * Iterates through elements in reverse of insertion order
-         * Example: For container [1,4,2,3], iteration order is 3,2,4,1
-         * 
-         * This iterator traverses the container from last element to first.
-         * All iterator operations are const and will not modify the container.
-         * Time Complexity: O(1) for all operations
+         * @brief Inserts a newly stored element into sorted_tree if it is maintained
+         * @param position Position of the element
+         * Time Complexity: O(log n + B) amortized in SortMode::Maintained, O(1) otherwise
          */
-        class ReverseOrder {
-            private:
-                const MyContainer* container; ///< Pointer to the container being iterated
-                size_t current;              ///< Current position in the container
-                bool is_end;                 ///< Flag indicating if iterator is at end position
-
-            public:
-                /**
-                 * @brief Constructor
-                 * @param c Pointer to the container to iterate over
-                 * @param end If true, creates an end iterator
-                 * Time Complexity: O(1)
-                 */
-                explicit ReverseOrder(const MyContainer* c, bool end = false) : 
-                        container(c), 
-                        current(end || c->size() == 0 ? 0 : c->size() - 1),
-                        is_end(end || c->size() == 0) {}
-
-                /**
-                 * @brief Copy constructor
-                 * @param other Iterator to copy from
-                 * Time Complexity: O(1) for primitive types copy
-                 */
-                ReverseOrder(const ReverseOrder& other) = default;
-
-                /**
-                 * @brief Assignment operator
-                 * @param other Iterator to assign from
-                 * @return Reference to this iterator
-                 * Time Complexity: O(1)
-                 */
-                ReverseOrder& operator=(const ReverseOrder& other) {
-                    if (this != &other) {
-                        container = other.container;
-                        current = other.current;
-                        is_end = other.is_end;
-                    }
-                    return *this;
-                }
+        void tree_pushed(size_t position) {
+            if (!tree_valid) return;
+            sorted_tree.insert(position, tree_order());
+        }
 
-                /**
-                 * @brief Equality comparison operator
-                 * @param other Iterator to compare with
-                 * @return true if iterators are at the same position or both at end
-                 * Time Complexity: O(1)
-                 */
-                bool operator==(const ReverseOrder& other) const {
-                    if (is_end && other.is_end) return true;
-                    if (is_end || other.is_end) return false;
-                    return current == other.current;                
-                }
+        /**
+         * @brief Drops sorted_tree after a change it cannot follow cheaply
+         * Time Complexity: O(n / B)
+         */
+        void tree_invalidate() const {
+            if (!tree_valid) return;
+            sorted_tree.clear();
+            tree_valid = false;
+        }
 
-                /**
-                 * @brief Inequality comparison operator
-                 * @param other Iterator to compare with
-                 * @return true if iterators are not at the same position
-                 * Time Complexity: O(1)
-                 */
-                bool operator!=(const ReverseOrder& other) const {
-                    return !(*this == other);
-                }
+        /**
+         * @brief Returns the index of the element with the given rank in ascending order
+         * @param rank Position in ascending order, must be less than size()
+         * @return Index into elements
+         * Time Complexity: O(1) once the rank is sorted; see extend_sorted() otherwise.
+         * O(log n) in SortMode::Maintained once its structure is built
+         *
+         * The permutation is shared by all sorted views and reset only when the
+         * version counter has moved, so several views over unchanged data sort once.
+         * Building runs under cache_lock; once the permutation or the maintained
+         * order is complete for the current version, reads take no lock.
+         */
+        size_t sorted_at(size_t rank) const {
+            if (!cache_lock.ready(version)) {
+                std::lock_guard<detail::CacheLock> guard(cache_lock);
+                return place_sorted(rank);
+            }
+            if (mode == SortMode::Maintained) {
+                return sorted_tree.at(rank);
+            }
+            return (*sorted_cache)[rank];
+        }
 
-                /**
-                 * @brief Dereference operator
-                 * @return Const reference to the current element
-                 * @throws std::out_of_range if iterator is at end or invalid position
-                 * Time Complexity: O(1)
-                 */
-                const T& operator*() const {
-                    if (is_end || current >= container->size()) {
-                        throw std::out_of_range("Iterator out of bounds");
-                    }
-                    return (*container)[current];
-                }
+        /**
+         * @brief Places the given rank and returns its index, with cache_lock held
+         * @param rank Position in ascending order, must be less than size()
+         * @return Index into elements
+         * Time Complexity: see sorted_at()
+         */
+        size_t place_sorted(size_t rank) const {
+            if (mode == SortMode::Maintained) {
+                if (!tree_valid) build_tree();
+                cache_lock.mark_ready(version);
+                return sorted_tree.at(rank);
+            }
+            if (!sorted_valid || sorted_version != version) {
+                reset_sorted();
+            }
+            if (rank >= sorted_front && rank < sorted_cache->size() - sorted_back) {
+                extend_sorted(rank);
+            }
+            if (sorted_front == sorted_cache->size()) {
+                cache_lock.mark_ready(version);
+            }
+            return (*sorted_cache)[rank];
+        }
 
-                /**
-                 * @brief Pre-increment operator (moves backwards)
-                 * @return Reference to this iterator after decrementing
-                 * Time Complexity: O(1)
-                 * 
-                 * If already at end, remains at end.
-                 * If decrement would go past beginning, moves to end position.
-                 */
-                ReverseOrder& operator++() {
-                    if (!is_end) {
-                        if (current > 0) {
-                            --current;
-                        } else {
-                            is_end = true;
-                            current = 0;  
+        /**
+         * @brief Sorts enough of the unsorted middle range to place the given rank
+         * @param rank Rank inside the unsorted range [sorted_front, n - sorted_back)
+         * Time Complexity: O(m log m) in Full mode where m is the unsorted range,
+         * O(m) for arithmetic T; O(m + c log c) in Incremental mode where c is
+         * the chunk placed
+         *
+         * In Incremental mode the sorted prefix or suffix, whichever is nearer to
+         * rank, at least doubles per call, so reading the first k ranks of either
+         * end costs O(n log(k / 64) + k log k) instead of a full sort. Once a chunk
+         * would cover half of what is left, the rest is sorted outright.
+         */
+        void extend_sorted(size_t rank) const {
+            auto less = [this](size_t i1, size_t i2) { return sorted_before(i1, i2); };
+            own_sorted().visit([&](auto first, auto last) {
+                const size_t n = static_cast<size_t>(last - first);
+                size_t lo = sorted_front;
+                size_t hi = n - sorted_back;
+
+                if (mode == SortMode::Incremental) {
+                    if (rank - lo < hi - rank) {
+                        size_t chunk = std::max({incremental_min_chunk, sorted_front, rank - lo + 1});
+                        if (chunk < (hi - lo) / 2) {
+                            std::nth_element(first + lo, first + lo + chunk, first + hi, less);
+                            std::sort(first + lo, first + lo + chunk, less);
+                            sorted_front += chunk;
+                            return;
+                        }
+                    } else {
+                        size_t chunk = std::max({incremental_min_chunk, sorted_back, hi - rank});
+                        if (chunk < (hi - lo) / 2) {
+                            std::nth_element(first + lo, first + hi - chunk, first + hi, less);
+                            std::sort(first + hi - chunk, first + hi, less);
+                            sorted_back += chunk;
+                            return;
                         }
                     }
-                    return *this;
                 }
 
-                /**
-                 * @brief Post-increment operator
-                 * @return Copy of iterator before incrementing
-                 * Time Complexity: O(1)
-                 */
-                ReverseOrder operator++(int) {
-                    ReverseOrder temp = *this;
-                    ++(*this);
-                    return temp;
+                // An untouched permutation is still in index order
+                if (lo == 0 && hi == n) {
+                    sort_fresh(first, first + hi);
+                } else {
+                    std::sort(first + lo, first + hi, less);
                 }
+                sorted_front = n;
+                sorted_back = 0;
+            });
+        }
 
-                /**
-                 * @brief Get iterator to the beginning (end of container)
-                 * @return Iterator pointing to the last element
-                 * Time Complexity: O(1)
-                 */
-                ReverseOrder begin() const {
-                    return ReverseOrder(container, false);
-                }
+    public:
+        /**
+         * @brief Default constructor
+         * Creates an empty container
+         * Time Complexity: O(1)
+         */
+        MyContainer() = default;
 
-                /**
-                 * @brief Get iterator to the end (start of container)
-                 * @return Iterator pointing before the first element
-                 * Time Complexity: O(1)
-                 */
-                ReverseOrder end() const {
-                    return ReverseOrder(container, true);
-                }
-        };
+        /**
+         * @brief Creates an empty container drawing memory from alloc
+         * @param alloc Allocator for elements and internal buffers
+         * Time Complexity: O(1)
+         */
+        explicit MyContainer(const Allocator& alloc) :
+            elements(alloc),
+            sorted_cache(IndexAllocator(alloc)),
+            sorted_tree(IndexAllocator(alloc)) {}
 
         /**
-         * @brief Ascending order iterator
-         * Iterates through elements from smallest to largest
-         * Example: For container [4,1,3,2], iteration order is 1,2,3,4
-         * 
-         * This iterator provides sorted access to elements in ascending order.
-         * Creates and maintains a sorted index array for efficient iteration.
-         * Time Complexity: O(n log n) for construction, O(1) for iteration operations
+         * @brief Constructs a container over an existing storage
+         * @param storage Elements in insertion order, e.g. a detail::MappedVector
+         * opened on a file; moved into the container
+         * Time Complexity: O(1) for storages that move in O(1)
          */
-        class AscendingOrder {
-        private:
-            const MyContainer* container;       ///< Pointer to the container being iterated
-            std::vector<size_t> sorted_indices; ///< Indices sorted by element values
-            size_t current;                     ///< Current position in sorted_indices
-            bool is_end;                        ///< Flag indicating if iterator is at end position
+        explicit MyContainer(Storage&& storage) :
+            elements(std::move(storage)),
+            sorted_cache(IndexAllocator(elements.get_allocator())),
+            sorted_tree(IndexAllocator(elements.get_allocator())) {}
 
-                    public:
-            /**
-             * @brief Constructor
-             * @param c Pointer to the container to iterate over
-             * @param end If true, creates an end iterator
-             * Time Complexity: O(n log n) where n is container size
-             */
-            explicit AscendingOrder(const MyContainer* c, bool end = false) : 
-                container(c), 
-                current(end || c->size() == 0 ? c->size() : 0),
-                is_end(end || c->size() == 0) {
-                sorted_indices.resize(c->size());
-                for (size_t i = 0; i < c->size(); ++i) {
-                    sorted_indices[i] = i;
-                }
-                std::sort(sorted_indices.begin(), sorted_indices.end(),
-                    [c](size_t i1, size_t i2) {
-                        return (*c)[i1] < (*c)[i2];
-                    });
+        /**
+         * @brief Constructs a container holding the elements of [first, last)
+         * @param first Iterator to the first element
+         * @param last Iterator past the last element
+         * @param alloc Allocator for elements and internal buffers
+         * Time Complexity: O(n), a single allocation for forward iterators
+         */
+        template<typename InputIt, typename = std::enable_if_t<detail::is_input_iterator<InputIt>::value>>
+        MyContainer(InputIt first, InputIt last, const Allocator& alloc = Allocator()) :
+            elements(first, last, alloc),
+            sorted_cache(IndexAllocator(alloc)),
+            sorted_tree(IndexAllocator(alloc)) {}
+
+        /**
+         * @brief Constructs a container holding the listed elements
+         * @param values Elements in insertion order
+         * @param alloc Allocator for elements and internal buffers
+         * Time Complexity: O(n), a single allocation
+         */
+        MyContainer(std::initializer_list<T> values, const Allocator& alloc = Allocator()) :
+            elements(values, alloc),
+            sorted_cache(IndexAllocator(alloc)),
+            sorted_tree(IndexAllocator(alloc)) {}
+
+        /**
+         * @brief Constructs a container holding the elements of a range
+         * @param range Any range usable with std::begin/std::end; elements
+         * are moved out of it when it is passed as an rvalue
+         * @param alloc Allocator for elements and internal buffers
+         * Time Complexity: O(n), a single allocation for sized ranges
+         */
+        template<typename Range, typename = std::enable_if_t<
+            detail::is_range<Range>::value &&
+            !std::is_same<std::decay_t<Range>, MyContainer>::value &&
+            !std::is_same<std::decay_t<Range>, std::initializer_list<T>>::value>>
+        explicit MyContainer(Range&& range, const Allocator& alloc = Allocator()) :
+            MyContainer(alloc) {
+            append_range(std::forward<Range>(range));
+        }
+
+        /**
+         * @brief Copy constructor
+         * @param other Container to copy from
+         * Time Complexity: O(n) where n is the size of other
+         *
+         * The allocator is chosen as for std::vector, so a std::pmr container is
+         * copied into the default memory resource. The sorted permutation is
+         * shared rather than copied when the allocators compare equal, so the
+         * copy's sorted views need no sort until one of the two containers changes.
+         */
+        MyContainer(const MyContainer& other) :
+            MyContainer(other, std::allocator_traits<Allocator>::select_on_container_copy_construction(
+                other.get_allocator())) {}
+
+        /**
+         * @brief Copy constructor drawing memory from alloc
+         * @param other Container to copy from
+         * @param alloc Allocator for the copy's elements and internal buffers
+         * Time Complexity: O(n) where n is the size of other
+         */
+        MyContainer(const MyContainer& other, const Allocator& alloc) :
+            elements(other.elements, alloc),
+            version(other.version),
+            mode(other.mode),
+            value_index(other.copy_index()),
+            sorted_cache(IndexAllocator(alloc)),
+            sorted_tree(IndexAllocator(alloc)) {
+            adopt_sorted(other, false);
+        }
+
+        /**
+         * @brief Assignment operator
+         * @param other Container to assign from
+         * @return Reference to this container
+         * Time Complexity: O(n) where n is the size of other
+         */
+        MyContainer& operator=(const MyContainer& other) {
+            if (this != &other) {
+                elements = other.elements;
+                version = other.version;
+                mode = other.mode;
+                value_index = other.copy_index();
+                adopt_sorted(other, false);
             }
+            return *this;
+        }
 
-            /**
-             * @brief Copy constructor
-             * Time Complexity: O(n) for vector copy
-             */
-            AscendingOrder(const AscendingOrder& other) = default;
+        /**
+         * @brief Move constructor
+         * @param other Container to move from, left empty
+         * Time Complexity: O(1)
+         *
+         * Iterators hold a pointer to the container they were created from,
+         * so iterators over other do not follow the elements to this container.
+         */
+        MyContainer(MyContainer&& other) noexcept(std::is_nothrow_move_constructible<Storage>::value) :
+            elements(std::move(other.elements)),
+            version(other.version),
+            mode(other.mode),
+            value_index(std::move(other.value_index)),
+            sorted_cache(std::move(other.sorted_cache)),
+            sorted_front(other.sorted_front),
+            sorted_back(other.sorted_back),
+            sorted_version(other.sorted_version),
+            sorted_valid(other.sorted_valid),
+            sorted_tree(std::move(other.sorted_tree)),
+            tree_valid(other.tree_valid) {
+            other.reset_moved_from();
+        }
 
-            /**
-             * @brief Copy constructor
-             * @param other Iterator to copy from
-             * Time Complexity: O(n) for sorted_indices vector copy
-             */
-            AscendingOrder& operator=(const AscendingOrder& other) {
-                if (this != &other) {
-                    container = other.container;
-                    current = other.current;
-                    is_end = other.is_end;
-                    sorted_indices = other.sorted_indices;
-                }
-                return *this;
+        /**
+         * @brief Move assignment operator
+         * @param other Container to move from, left empty
+         * @return Reference to this container
+         * Time Complexity: O(n) to destroy the current elements, O(n) more when
+         * the allocators differ and do not propagate, as for std::vector
+         */
+        MyContainer& operator=(MyContainer&& other) noexcept(std::is_nothrow_move_assignable<Storage>::value) {
+            if (this != &other) {
+                elements = std::move(other.elements);
+                version = other.version;
+                mode = other.mode;
+                value_index = std::move(other.value_index);
+                adopt_sorted(other, true);
+                other.reset_moved_from();
             }
+            return *this;
+        }
 
-            /**
-             * @brief Equality comparison operator
-             * @param other Iterator to compare with
-             * @return true if iterators are at the same position or both at end
-             * Time Complexity: O(1)
-             */
-            bool operator==(const AscendingOrder& other) const {
-                if (is_end && other.is_end) return true;
-                if (is_end || other.is_end) return false;
-                return current == other.current;            
+        /**
+         * @brief Returns the allocator the container draws memory from
+         * Time Complexity: O(1)
+         */
+        allocator_type get_allocator() const {
+            return elements.get_allocator();
+        }
+
+        /**
+         * @brief Returns the sequence holding the elements, e.g. to sync a MappedContainer
+         * Time Complexity: O(1)
+         */
+        const Storage& storage() const {
+            return elements;
+        }
+
+        /**
+         * @brief Adds a new element to the container
+         * @param value The value to add
+         * Time Complexity: O(1) amortized
+         */
+        void add(const T& value) {
+            elements.push_back(value);
+            value_index.pushed(elements.back());
+            tree_pushed(elements.size() - 1);
+            ++version;
+        }
+
+        /**
+         * @brief Adds a new element to the container by moving it
+         * @param value The value to move into the container
+         * Time Complexity: O(1) amortized
+         */
+        void add(T&& value) {
+            elements.push_back(std::move(value));
+            value_index.pushed(elements.back());
+            tree_pushed(elements.size() - 1);
+            ++version;
+        }
+
+        /**
+         * @brief Constructs a new element in place at the end of the container
+         * @param args Arguments forwarded to the constructor of T
+         * Time Complexity: O(1) amortized
+         */
+        template<typename... Args>
+        void emplace(Args&&... args) {
+            elements.emplace_back(std::forward<Args>(args)...);
+            value_index.pushed(elements.back());
+            tree_pushed(elements.size() - 1);
+            ++version;
+        }
+
+        /**
+         * @brief Appends the elements of [first, last) in one pass
+         * @param first Iterator to the first element
+         * @param last Iterator past the last element
+         * Time Complexity: O(m) where m is the range length, with at most one
+         * reallocation for forward iterators
+         */
+        template<typename InputIt, typename = std::enable_if_t<detail::is_input_iterator<InputIt>::value>>
+        void append(InputIt first, InputIt last) {
+            size_t old_size = elements.size();
+            elements.insert(elements.end(), first, last);
+            for (size_t i = old_size; i < elements.size(); ++i) {
+                value_index.pushed(elements[i]);
+                tree_pushed(i);
             }
+            ++version;
+        }
 
-            /**
-             * @brief Inequality comparison operator
-             * @param other Iterator to compare with
-             * @return true if iterators are not at the same position
-             * Time Complexity: O(1)
-             */
-            bool operator!=(const AscendingOrder& other) const {
-                return !(*this == other);
+        /**
+         * @brief Reserves storage for at least n elements
+         * @param n Number of elements to make room for
+         * Time Complexity: O(size()) if storage has to grow, O(1) otherwise
+         */
+        void reserve(size_t n) {
+            elements.reserve(n);
+        }
+
+        /**
+         * @brief Returns how many elements fit before storage has to grow
+         * @return Current capacity in elements
+         * Time Complexity: O(1)
+         */
+        size_t capacity() const {
+            return elements.capacity();
+        }
+
+        /**
+         * @brief Starts maintaining a hash index from values to positions
+         * @tparam Hash Hash function for T, std::hash<T> by default
+         * Time Complexity: O(n) expected
+         *
+         * While enabled, add/remove keep the index up to date and remove,
+         * remove_unordered, contains and count find values in expected
+         * O(log n) instead of scanning. Non-const operator[] marks the index
+         * stale and the next lookup rebuilds it.
+         */
+        template<typename Hash = std::hash<T>>
+        void enable_hash_index() {
+            value_index.template enable<Hash>(elements);
+        }
+
+        /**
+         * @brief Stops maintaining the hash index and releases its memory
+         * Time Complexity: O(n)
+         */
+        void disable_hash_index() {
+            value_index.disable();
+        }
+
+        /**
+         * @brief Returns whether the hash index is maintained
+         * @return true if enable_hash_index() is in effect
+         * Time Complexity: O(1)
+         */
+        bool has_hash_index() const {
+            return value_index.enabled();
+        }
+
+        /**
+         * @brief Checks whether an element equal to value is stored
+         * @param value The value to look for
+         * @return true if at least one element compares equal
+         * Time Complexity: O(1) expected with the hash index, O(n) otherwise
+         */
+        bool contains(const T& value) const {
+            return count(value) != 0;
+        }
+
+        /**
+         * @brief Counts the elements equal to value
+         * @param value The value to count
+         * @return Number of elements that compare equal
+         * Time Complexity: O(1) expected per match with the hash index, O(n) otherwise
+         */
+        size_t count(const T& value) const {
+            if (value_index.enabled()) {
+                return fresh_index().count(value);
             }
+            return static_cast<size_t>(std::count(elements.begin(), elements.end(), value));
+        }
 
-            /**
-             * @brief Dereference operator
-             * @return Const reference to the current element
-             * @throws std::out_of_range if iterator is at end or invalid position
-             * Time Complexity: O(1)
-             */
-            const T& operator*() const {
-                if (current >= container->size()) {
-                    throw std::out_of_range("Iterator out of bounds");
+        /**
+         * @brief Approximate number of bytes owned by the container
+         * @return Size of the object plus element storage, cached permutation,
+         * maintained order and hash index; memory owned by the elements
+         * themselves is not counted
+         * Time Complexity: O(n / B) for the maintained order's blocks
+         */
+        size_t memory_usage() const {
+            std::lock_guard<detail::CacheLock> guard(cache_lock);
+            return sizeof(*this)
+                + detail::heap_bytes(elements)
+                + sorted_cache.memory_usage()
+                + sorted_tree.memory_usage()
+                + value_index.memory_usage();
+        }
+
+#if __has_include(<sys/uio.h>)
+        /**
+         * @brief Writes the elements in insertion order in the binary format
+         * @param fd File descriptor open for writing
+         * @throws std::system_error if writing fails
+         * Time Complexity: O(n)
+         *
+         * Trivially copyable elements in contiguous storage go out with the
+         * header in a single writev straight from the container; otherwise the
+         * file is encoded into one buffer first. See BinaryFormat.hpp.
+         */
+        void save(int fd) const {
+            static_assert(detail::is_serializable<T>::value,
+                          "save needs a trivially copyable T or std::string");
+            detail::Checksum checksum;
+            if constexpr (std::is_trivially_copyable<T>::value && detail::is_contiguous_storage<Storage>::value) {
+                const T* data = elements.empty() ? nullptr : &elements[0];
+                size_t bytes = elements.size() * sizeof(T);
+                checksum.update(data, bytes);
+                detail::BinaryHeader header = detail::make_header<T>(elements.size(), bytes, checksum.value());
+                iovec parts[2] = {{&header, sizeof(header)}, {const_cast<T*>(data), bytes}};
+                detail::write_all(fd, parts, bytes ? 2 : 1);
+            } else {
+                std::vector<char> buffer(sizeof(detail::BinaryHeader));
+                for (const T& element : elements) {
+                    if constexpr (std::is_trivially_copyable<T>::value) {
+                        const char* raw = reinterpret_cast<const char*>(&element);
+                        buffer.insert(buffer.end(), raw, raw + sizeof(T));
+                    } else {
+                        detail::encode_string(buffer, element);
+                    }
                 }
-                return (*container)[sorted_indices[current]];
+                size_t bytes = buffer.size() - sizeof(detail::BinaryHeader);
+                checksum.update(buffer.data() + sizeof(detail::BinaryHeader), bytes);
+                detail::BinaryHeader header = detail::make_header<T>(elements.size(), bytes, checksum.value());
+                std::memcpy(buffer.data(), &header, sizeof(header));
+                iovec part = {buffer.data(), buffer.size()};
+                detail::write_all(fd, &part, 1);
             }
+        }
 
-            /**
-             * @brief Pre-increment operator
-             * @return Reference to this iterator after incrementing
-             * Time Complexity: O(1)
-             */
-            AscendingOrder& operator++() {
-                if (!is_end) {
-                    ++current;
-                    if (current >= container->size()) {
-                        is_end = true;
-                        current = container->size();
-                    }
+        /**
+         * @brief Writes the elements to a file in the binary format, replacing it
+         * @param path File to create or truncate
+         * @throws std::system_error if the file cannot be opened or written
+         * Time Complexity: O(n)
+         */
+        void save(const std::string& path) const {
+            detail::FileCloser file{::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644)};
+            if (file.fd < 0) throw std::system_error(errno, std::generic_category(), "open");
+            save(file.fd);
+        }
+
+        /**
+         * @brief Reads a container written by save()
+         * @param fd File descriptor positioned at the start of the header
+         * @param alloc Allocator for elements and internal buffers
+         * @return Container holding the saved elements in insertion order
+         * @throws std::runtime_error if the input is not a file of T elements,
+         * is truncated or fails its checksum
+         * @throws std::system_error if reading fails
+         * Time Complexity: O(n)
+         */
+        static MyContainer load(int fd, const Allocator& alloc = Allocator()) {
+            static_assert(detail::is_serializable<T>::value,
+                          "load needs a trivially copyable T or std::string");
+            detail::BinaryHeader header;
+            detail::read_exact(fd, &header, sizeof(header));
+            detail::check_header<T>(header);
+            MyContainer result(alloc);
+            result.read_payload(fd, header);
+            return result;
+        }
+
+        /**
+         * @brief Reads a container from a file written by save()
+         * @param path File to read
+         * @param alloc Allocator for elements and internal buffers
+         * @return Container holding the saved elements in insertion order
+         * @throws std::system_error if the file cannot be opened or read
+         * @throws std::runtime_error if the file is not valid for T
+         * Time Complexity: O(n)
+         */
+        static MyContainer load(const std::string& path, const Allocator& alloc = Allocator()) {
+            detail::FileCloser file{::open(path.c_str(), O_RDONLY)};
+            if (file.fd < 0) throw std::system_error(errno, std::generic_category(), "open");
+            return load(file.fd, alloc);
+        }
+#endif
+
+        /**
+         * @brief Removes the first occurrence of an element
+         * @param value The value to remove
+         * @throws std::runtime_error if the element is not found
+         * Time Complexity: O(n) where n is the container size; with the hash
+         * index enabled the element is found in O(log n) expected and only the
+         * shift of later elements is linear
+         */
+        void remove(const T& value) {
+            size_t position = find_position(value);
+            value_index.erasing(position, elements[position]);
+            if (tree_valid) {
+                sorted_tree.erase(position, tree_order());
+            }
+            elements.erase(elements.begin() + position);
+            if (tree_valid) {
+                sorted_tree.shift_down_after(position);
+            }
+            ++version;
+        }
+
+        /**
+         * @brief Removes the first occurrence of an element without preserving order
+         * @param value The value to remove
+         * @throws std::runtime_error if the element is not found
+         * Time Complexity: O(n) to find the element (O(log n) expected with the
+         * hash index enabled), O(1) to remove it
+         *
+         * The last element is moved into the removed element's slot instead of
+         * shifting every later element down. Order and ReverseOrder therefore no
+         * longer follow insertion order afterwards: the former last element is
+         * visited where the removed one used to be. Sorted and middle-out views
+         * are unaffected beyond the removal itself.
+         */
+        void remove_unordered(const T& value) {
+            size_t position = find_position(value);
+            size_t last = elements.size() - 1;
+            value_index.replacing_with_last(position, elements[position], elements.back());
+            if (tree_valid) {
+                sorted_tree.erase(position, tree_order());
+                if (position != last) sorted_tree.erase(last, tree_order());
+            }
+            if (position != last) {
+                elements[position] = std::move(elements.back());
+            }
+            elements.pop_back();
+            if (position != last) {
+                tree_pushed(position);
+            }
+            ++version;
+        }
+
+        /**
+         * @brief Removes every element equal to value
+         * @param value The value to remove
+         * @return Number of elements removed
+         * Time Complexity: O(n), a single compaction pass
+         */
+        size_t remove_all(const T& value) {
+            return compact([&value](const T& element) { return element == value; });
+        }
+
+        /**
+         * @brief Removes every element matching a predicate
+         * @param pred Callable taking const T& and returning true for elements to remove
+         * @return Number of elements removed
+         * Time Complexity: O(n) predicate calls, a single compaction pass
+         */
+        template<typename Predicate>
+        size_t remove_if(Predicate pred) {
+            return compact(pred);
+        }
+
+        /**
+         * @brief Removes the first occurrence of each listed value
+         * @param values Range of values; a value listed k times removes k occurrences
+         * @throws std::runtime_error if some value has fewer occurrences than listed,
+         * in which case the container is left unchanged
+         * Time Complexity: O((n + m) log m) where m is the number of values,
+         * a single compaction pass
+         *
+         * Equivalent to calling remove() once per listed value, but the stored
+         * elements are shifted only once.
+         */
+        template<typename Range>
+        void remove_many(const Range& values) {
+            // Distinct listed values, sorted, each with how many occurrences to remove
+            std::vector<const T*> listed;
+            for (const T& value : values) {
+                listed.push_back(&value);
+            }
+            auto less = [](const T* a, const T* b) { return *a < *b; };
+            std::sort(listed.begin(), listed.end(), less);
+            std::vector<std::pair<const T*, size_t>> pending;
+            for (const T* value : listed) {
+                if (pending.empty() || *pending.back().first < *value) {
+                    pending.push_back({value, 0});
                 }
-                return *this;
+                ++pending.back().second;
+            }
+            if (pending.empty()) return;
+
+            auto lookup = [&pending](const T& element) {
+                auto it = std::lower_bound(pending.begin(), pending.end(), element,
+                    [](const std::pair<const T*, size_t>& entry, const T& v) { return *entry.first < v; });
+                return (it != pending.end() && *it->first == element) ? it : pending.end();
+            };
+
+            std::vector<std::pair<const T*, size_t>> remaining(pending);
+            size_t unmatched = listed.size();
+            for (const T& element : elements) {
+                auto it = lookup(element);
+                if (it != pending.end() && remaining[it - pending.begin()].second > 0) {
+                    --remaining[it - pending.begin()].second;
+                    --unmatched;
+                }
+            }
+            if (unmatched != 0) {
+                throw std::runtime_error("Element not found");
             }
 
-            /**
-             * @brief Post-increment operator
-             * @return Copy of iterator before incrementing
-             * Time Complexity: O(1)
-             */
-            AscendingOrder operator++(int) {
-                AscendingOrder temp = *this;
-                ++(*this);
-                return temp;
+            compact([&](const T& element) {
+                auto it = lookup(element);
+                if (it == pending.end() || it->second == 0) return false;
+                --it->second;
+                return true;
+            });
+        }
+
+        /**
+         * @brief Removes the elements at positions [first_index, last_index)
+         * @param first_index Position of the first element to remove
+         * @param last_index Position past the last element to remove
+         * @throws std::out_of_range if the range is invalid
+         * Time Complexity: O(n - first_index), a single shift of later elements
+         */
+        void erase(size_t first_index, size_t last_index) {
+            if (first_index > last_index || last_index > elements.size()) {
+                throw std::out_of_range("Index out of bounds");
             }
+            if (first_index == last_index) return;
+            elements.erase(elements.begin() + first_index, elements.begin() + last_index);
+            value_index.invalidate();
+            tree_invalidate();
+            ++version;
+        }
 
-            /**
-             * @brief Get iterator to the beginning (smallest element)
-             * @return Iterator pointing to the smallest element
-             * Time Complexity: O(n log n) for sorting
-             */
-            AscendingOrder begin() const {
-                return AscendingOrder(container, false);
+        /**
+         * @brief Returns the current size of the container
+         * @return Number of elements in the container
+         * Time Complexity: O(1)
+         */
+        size_t size() const {
+            return elements.size();
+        }
+
+        /**
+         * @brief Selects how the sorted permutation is built
+         * @param new_mode SortMode::Full, SortMode::Incremental or SortMode::Maintained
+         * Time Complexity: O(1), O(n) when leaving SortMode::Maintained
+         *
+         * Already placed ranks stay valid, so switching between Full and
+         * Incremental does not re-sort. Entering Maintained builds its
+         * structure on the next sorted read; leaving it releases the structure.
+         */
+        void set_sort_mode(SortMode new_mode) {
+            if (new_mode != SortMode::Maintained) {
+                tree_invalidate();
             }
+            mode = new_mode;
+            cache_lock.forget();
+        }
 
-             /**
-             * @brief Get iterator to the end
-             * @return Iterator pointing past the largest element
-             * Time Complexity: O(1)
-             */
-            AscendingOrder end() const {
-                return AscendingOrder(container, true);
+        /**
+         * @brief Returns how the sorted permutation is built
+         * @return The current SortMode
+         * Time Complexity: O(1)
+         */
+        SortMode sort_mode() const {
+            return mode;
+        }
+
+        /**
+         * @brief Checked access to an element
+         * @param index The index to access
+         * @return Reference to the element at the specified index
+         * @throws std::out_of_range if index is invalid
+         * Time Complexity: O(1)
+         *
+         * The returned reference may be used to modify the element, so this
+         * invalidates the cached sorted permutation and the hash index. In
+         * SortMode::Maintained the order is rebuilt on the next sorted read.
+         */
+        T& at(size_t index) {
+            if (index >= elements.size()) {
+                throw std::out_of_range("Index out of bounds");
             }
-        };
+            value_index.invalidate();
+            tree_invalidate();
+            ++version;
+            return elements[index];
+        }
 
         /**
-         * @brief Descending order iterator
-         * Iterates through elements from largest to smallest
-         * Example: For container [4,1,3,2], iteration order is 4,3,2,1
+         * @brief Checked const access to an element
+         * @param index The index to access
+         * @return Const reference to the element at the specified index
+         * @throws std::out_of_range if index is invalid
+         * Time Complexity: O(1)
+         */
+        const T& at(size_t index) const {
+            if (index >= elements.size()) {
+                throw std::out_of_range("Index out of bounds");
+            }
+            return elements[index];
+        }
+
+        /**
+         * @brief Access operator for the container
+         * @param index The index to access
+         * @return Reference to the element at the specified index
+         * @throws std::out_of_range if index is invalid, unless CONTAINERS_UNCHECKED is defined
+         * Time Complexity: O(1)
+         *
+         * Invalidates the sorted permutation and the hash index like at().
+         */
+        T& operator[](size_t index) {
+            if (detail::checked_access && index >= elements.size()) {
+                throw std::out_of_range("Index out of bounds");
+            }
+            value_index.invalidate();
+            tree_invalidate();
+            ++version;
+            return elements[index];
+        }
+
+        /**
+         * @brief Const access operator for the container
+         * @param index The index to access
+         * @return Const reference to the element at the specified index
+         * @throws std::out_of_range if index is invalid, unless CONTAINERS_UNCHECKED is defined
+         * Time Complexity: O(1)
+         */
+        const T& operator[](size_t index) const {
+            if (detail::checked_access && index >= elements.size()) {
+                throw std::out_of_range("Index out of bounds");
+            }
+            return elements[index];
+        }
+
+        /**
+         * @brief Writes the elements of a view as [elem1,elem2,...,elemN] to a stream
+         * @param os Output stream
+         * @param view Any of the six orders of this container
+         * Time Complexity: O(n), plus a sort for sorted views
+         *
+         * Numbers and strings are formatted into a local buffer and written in
+         * 64 KiB chunks when the stream uses default formatting flags, no field
+         * width and the classic locale; floating point values honour
+         * os.precision(). Otherwise every element goes through operator<< so
+         * the stream's formatting applies.
+         */
+        template<typename View>
+        void write_to(std::ostream& os, const View& view) const {
+            constexpr auto neutral = std::ios_base::skipws | std::ios_base::unitbuf;
+            if constexpr (detail::is_fast_formattable<T>::value) {
+                if ((os.flags() & ~neutral) == std::ios_base::dec && os.width() == 0 &&
+                    os.getloc() == std::locale::classic()) {
+                    auto sink = [&os](const char* data, size_t size) {
+                        os.write(data, static_cast<std::streamsize>(size));
+                    };
+                    write_text(view, sink, static_cast<int>(os.precision()));
+                    return;
+                }
+            }
+            os << "[";
+            bool first = true;
+            for (const T& element : view) {
+                if (!first) os << ",";
+                os << element;
+                first = false;
+            }
+            os << "]";
+        }
+
+        /**
+         * @brief Writes the elements of a view as [elem1,elem2,...,elemN] to a C stream
+         * @param file Stream open for writing
+         * @param view Any of the six orders of this container
+         * @param precision Significant digits for floating point values
+         * @throws std::system_error if a write fails
+         * Time Complexity: O(n), plus a sort for sorted views
+         */
+        template<typename View>
+        void write_to(std::FILE* file, const View& view, int precision = 6) const {
+            auto sink = [file](const char* data, size_t size) {
+                if (std::fwrite(data, 1, size, file) != size) {
+                    throw std::system_error(errno, std::generic_category(), "fwrite");
+                }
+            };
+            write_text(view, sink, precision);
+        }
+
+#if __has_include(<sys/uio.h>)
+        /**
+         * @brief Writes the elements of a view as [elem1,elem2,...,elemN] to a file descriptor
+         * @param fd File descriptor open for writing
+         * @param view Any of the six orders of this container
+         * @param precision Significant digits for floating point values
+         * @throws std::system_error if a write fails
+         * Time Complexity: O(n), plus a sort for sorted views
+         */
+        template<typename View>
+        void write_to(int fd, const View& view, int precision = 6) const {
+            auto sink = [fd](const char* data, size_t size) {
+                iovec part = {const_cast<char*>(data), size};
+                detail::write_all(fd, &part, 1);
+            };
+            write_text(view, sink, precision);
+        }
+
+        /**
+         * @brief Writes the elements in insertion order to a file descriptor
+         * @param fd File descriptor open for writing
+         * @throws std::system_error if a write fails
+         * Time Complexity: O(n)
+         */
+        void write_to(int fd) const {
+            write_to(fd, order());
+        }
+#endif
+
+        /**
+         * @brief Writes the elements in insertion order to a C stream
+         * @param file Stream open for writing
+         * @throws std::system_error if a write fails
+         * Time Complexity: O(n)
+         */
+        void write_to(std::FILE* file) const {
+            write_to(file, order());
+        }
+
+        /**
+         * @brief Output stream operator
+         * @param os Output stream
+         * @param container Container to output
+         * @return Reference to the output stream
+         * Time Complexity: O(n)
          * 
-         * This iterator provides sorted access to elements in descending order.
-         * Creates and maintains a sorted index array for efficient iteration.
-         * Time Complexity: O(n log n) for construction, O(1) for iteration operations
+         * Formats the container as [elem1,elem2,...,elemN] in insertion order,
+         * through write_to.
          */
-        class DescendingOrder {
-        private:
-            const MyContainer* container;        ///< Pointer to the container being iterated
-            std::vector<size_t> sorted_indices; ///< Indices sorted by element values
-            size_t current;                     ///< Current position in sorted_indices
-            bool is_end;                        ///< Flag indicating if iterator is at end position
+        friend std::ostream& operator<<(std::ostream& os, const MyContainer& container) {
+            container.write_to(os, container.order());
+            return os;
+        }
+
+        /**
+         * @brief Creates a container from text such as "[1,2,3]", "1 2 3" or one number per line
+         * @param text Numbers separated by commas and/or whitespace, optionally within
+         * brackets, so the output of operator<< parses back
+         * @param alloc Allocator for elements and internal buffers
+         * @return Container holding the numbers in the order they appear
+         * @throws std::runtime_error naming the offset of the first malformed element
+         * Time Complexity: O(length of text), with a single allocation for the elements
+         *
+         * A first pass counts the elements so storage is reserved once; the
+         * second parses them with std::from_chars.
+         */
+        static MyContainer parse(std::string_view text, const Allocator& alloc = Allocator()) {
+            static_assert(detail::is_chars_formattable<T>::value, "parse needs an arithmetic T");
+            MyContainer result(alloc);
+            result.elements.reserve(detail::count_tokens(text));
+            detail::parse_text<T>(text, [&result](const T& value) { result.elements.push_back(value); });
+            ++result.version;
+            return result;
+        }
+
+        /**
+         * @brief Creates a container from text read from a C stream until end of file
+         * @param file Stream open for reading
+         * @param alloc Allocator for elements and internal buffers
+         * @return Container holding the numbers in the order they appear
+         * @throws std::system_error if reading fails
+         * @throws std::runtime_error if the text is malformed
+         * Time Complexity: O(length of the input)
+         *
+         * The text is parsed one 1 MiB block at a time as it is read, so
+         * memory beyond the elements stays at one block however large the
+         * input is.
+         */
+        static MyContainer read_from(std::FILE* file, const Allocator& alloc = Allocator()) {
+            static_assert(detail::is_chars_formattable<T>::value, "read_from needs an arithmetic T");
+            MyContainer result(alloc);
+            detail::TextParser<T> parser;
+            auto emit = [&result](const T& value) { result.elements.push_back(value); };
+            std::vector<char> block(text_block_size);
+            size_t got;
+            while ((got = std::fread(block.data(), 1, block.size(), file)) > 0) {
+                parser.feed(std::string_view(block.data(), got), emit);
+            }
+            if (std::ferror(file)) throw std::system_error(errno, std::generic_category(), "fread");
+            parser.finish(emit);
+            ++result.version;
+            return result;
+        }
 
+#if __has_include(<sys/uio.h>)
+        /**
+         * @brief Creates a container from text read from a file descriptor until end of file
+         * @param fd File descriptor open for reading
+         * @param alloc Allocator for elements and internal buffers
+         * @return Container holding the numbers in the order they appear
+         * @throws std::system_error if reading fails
+         * @throws std::runtime_error if the text is malformed
+         * Time Complexity: O(length of the input)
+         *
+         * The text is parsed one 1 MiB block at a time as it is read, so
+         * memory beyond the elements stays at one block however large the
+         * input is.
+         */
+        static MyContainer read_from(int fd, const Allocator& alloc = Allocator()) {
+            static_assert(detail::is_chars_formattable<T>::value, "read_from needs an arithmetic T");
+            MyContainer result(alloc);
+            detail::TextParser<T> parser;
+            auto emit = [&result](const T& value) { result.elements.push_back(value); };
+            std::vector<char> block(text_block_size);
+            while (true) {
+                ssize_t got = ::read(fd, block.data(), block.size());
+                if (got < 0) {
+                    if (errno == EINTR) continue;
+                    throw std::system_error(errno, std::generic_category(), "read");
+                }
+                if (got == 0) break;
+                parser.feed(std::string_view(block.data(), static_cast<size_t>(got)), emit);
+            }
+            parser.finish(emit);
+            ++result.version;
+            return result;
+        }
+#endif
+
+        // Iterator Classes
+
+        /**
+         * @brief Random-access machinery shared by every traversal order
+         * @tparam Derived The concrete iterator, which maps a traversal position to an
+         * element index through a private element_index(position) member
+         *
+         * An iterator is a container pointer and a position in [0, size()], where
+         * size() is the end. Every order visits each element exactly once, so moving,
+         * comparing and measuring distance are arithmetic on the position and only
+         * dereference depends on the order. Moving saturates at both ends instead of
+         * leaving the range, and positions left past the end by a removal compare as end.
+         * Time Complexity: O(1) for all operations apart from what element_index costs
+         */
+        template<typename Derived>
+        class OrderIterator {
         public:
+            using iterator_category = std::random_access_iterator_tag;
+            using value_type = T;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const T*;
+            using reference = const T&;
+
+        protected:
+            const MyContainer* container; ///< Pointer to the container being iterated
+            size_t current;               ///< Position in the traversal, size() at the end
+
+            /**
+             * @brief Creates a singular iterator that only compares equal to other singular iterators
+             * Time Complexity: O(1)
+             */
+            OrderIterator() : container(nullptr), current(0) {}
+
             /**
              * @brief Constructor
              * @param c Pointer to the container to iterate over
              * @param end If true, creates an end iterator
-             * Time Complexity: O(n log n) where n is container size
+             * Time Complexity: O(1)
              */
-            explicit DescendingOrder(const MyContainer* c, bool end = false) : 
-                container(c), 
-                current(end || c->size() == 0 ? c->size() : 0),
-                is_end(end || c->size() == 0) {  
-                if (c->size() == 0) return; 
-                
-                sorted_indices.resize(c->size());
-                for (size_t i = 0; i < c->size(); ++i) {
-                    sorted_indices[i] = i;
-                }
-                std::sort(sorted_indices.begin(), sorted_indices.end(),
-                    [c](size_t i1, size_t i2) {
-                        return (*c)[i1] > (*c)[i2];
-                    });
-            }
+            OrderIterator(const MyContainer* c, bool end) :
+                container(c),
+                current(end ? c->size() : 0) {}
 
             /**
-             * @brief Copy constructor
-             * @param other Iterator to copy from
-             * Time Complexity: O(n) for vector copy
+             * @brief Position clamped to the current end of the container
+             * Time Complexity: O(1)
              */
-            DescendingOrder(const DescendingOrder& other) = default;
+            size_t position() const {
+                return container ? std::min(current, container->size()) : current;
+            }
+
+        private:
+            const Derived& self() const { return static_cast<const Derived&>(*this); }
+            Derived& self() { return static_cast<Derived&>(*this); }
 
             /**
-             * @brief Copy constructor
-             * @param other Iterator to copy from
-             * Time Complexity: O(n) for sorted_indices vector copy
+             * @brief Moves the position by n, saturating at the beginning and the end
+             * @param n Signed number of steps
+             * Time Complexity: O(1)
              */
-            DescendingOrder& operator=(const DescendingOrder& other) {
-                if (this != &other) {
-                    container = other.container;
-                    current = other.current;
-                    is_end = other.is_end;
-                    sorted_indices = other.sorted_indices;
+            void advance(difference_type n) {
+                size_t pos = position();
+                if (n < 0) {
+                    size_t back = static_cast<size_t>(-(n + 1)) + 1;
+                    current = back >= pos ? 0 : pos - back;
+                } else {
+                    size_t ahead = container->size() - pos;
+                    current = static_cast<size_t>(n) >= ahead ? container->size() : pos + static_cast<size_t>(n);
                 }
-                return *this;
             }
-            
+
+        public:
             /**
-             * @brief Equality comparison operator
-             * @param other Iterator to compare with
-             * @return true if iterators are at the same position or both at end
-             * Time Complexity: O(1)
+             * @brief Dereference operator
+             * @return Const reference to the current element
+             * @throws std::out_of_range if iterator is at end or invalid position,
+             * unless CONTAINERS_UNCHECKED is defined
+             * Time Complexity: O(1), plus any sorting deferred to dereference
+             *
+             * The position is the only thing checked; element_index always yields
+             * a valid index for it, so the element is read without a second check.
              */
-            bool operator==(const DescendingOrder& other) const {
-                if (is_end && other.is_end) return true;
-                if (is_end || other.is_end) return false;
-                return current == other.current;
+            reference operator*() const {
+                if (detail::checked_access && current >= container->size()) {
+                    throw std::out_of_range("Iterator out of bounds");
+                }
+                return container->elements[self().element_index(current)];
             }
 
             /**
-             * @brief Inequality comparison operator
-             * @param other Iterator to compare with
-             * @return true if iterators are not at the same position
-             * Time Complexity: O(1)
+             * @brief Member access operator
+             * @return Pointer to the current element
+             * @throws std::out_of_range if iterator is at end or invalid position
+             * Time Complexity: Same as operator*
              */
-            bool operator!=(const DescendingOrder& other) const {
-                return !(*this == other);
+            pointer operator->() const {
+                return &**this;
             }
 
             /**
-             * @brief Dereference operator
-             * @return Const reference to the current element
-             * @throws std::out_of_range if iterator is at end or invalid position
-             * Time Complexity: O(1)
+             * @brief Subscript operator
+             * @param n Offset from this iterator
+             * @return Const reference to the element n positions away
+             * @throws std::out_of_range if that position is outside the container
+             * Time Complexity: Same as operator*
              */
-            const T& operator*() const {
-                if (is_end || current >= container->size()) {
-                    throw std::out_of_range("Iterator out of bounds");
-                }
-                return (*container)[sorted_indices[current]];
+            reference operator[](difference_type n) const {
+                return *(self() + n);
             }
 
             /**
              * @brief Pre-increment operator
              * @return Reference to this iterator after incrementing
              * Time Complexity: O(1)
+             *
+             * If already at end, remains at end.
              */
-            DescendingOrder& operator++() {
-                if (!is_end) {
-                    ++current;
-                    if (current >= container->size()) {
-                        is_end = true;
-                        current = container->size();
-                    }
-                }
-                return *this;
+            Derived& operator++() {
+                advance(1);
+                return self();
             }
 
             /**
@@ -666,356 +1629,324 @@ namespace containers {
              * @return Copy of iterator before incrementing
              * Time Complexity: O(1)
              */
-            DescendingOrder operator++(int) {
-                DescendingOrder temp = *this;
+            Derived operator++(int) {
+                Derived temp = self();
                 ++(*this);
                 return temp;
             }
 
             /**
-             * @brief Get iterator to the beginning (largest element)
-             * @return Iterator pointing to the largest element
-             * Time Complexity: O(n log n) for sorting
+             * @brief Pre-decrement operator
+             * @return Reference to this iterator after decrementing
+             * Time Complexity: O(1)
+             *
+             * If already at the beginning, remains at the beginning.
              */
-            DescendingOrder begin() const { 
-                return DescendingOrder(container, false); 
+            Derived& operator--() {
+                advance(-1);
+                return self();
             }
 
             /**
-             * @brief Get iterator to the end
-             * @return Iterator pointing past the smallest element
+             * @brief Post-decrement operator
+             * @return Copy of iterator before decrementing
              * Time Complexity: O(1)
              */
-            DescendingOrder end() const {
-                return DescendingOrder(container, true);
+            Derived operator--(int) {
+                Derived temp = self();
+                --(*this);
+                return temp;
             }
-        };
-
-        /**
-         * @brief Side cross order iterator
-         * Iterates alternating between smallest and largest remaining elements
-         * Example: For container [4,1,3,2], iteration order is 1,4,2,3
-         * 
-         * This iterator provides alternating access between minimum and maximum elements.
-         * Creates and maintains a pre-calculated traversal order for efficient iteration.
-         * Time Complexity: O(n log n) for construction, O(1) for iteration operations
-         */
-        class SideCrossOrder {
-        private:
-            const MyContainer* container; ///< Pointer to the container being iterated
-            std::vector<size_t> indices;  ///< Pre-calculated iteration order
-            size_t current;               ///< Current position in indices
-            bool is_end;                  ///< Flag indicating if iterator is at end position
 
-        public: 
             /**
-             * @brief Constructor
-             * @param c Pointer to the container to iterate over
-             * @param end If true, creates an end iterator
-             * Time Complexity: O(n log n) where n is container size
+             * @brief Moves the iterator forward by n positions
+             * @param n Signed number of steps, negative moves backward
+             * @return Reference to this iterator
+             * Time Complexity: O(1)
              */
-            explicit SideCrossOrder(const MyContainer* c, bool end = false) : 
-                container(c), 
-                current(0),
-                is_end(end) {
-                
-                if (c->size() == 0 || end) {
-                    is_end = true;
-                    return;
-                }
-                
-                std::vector<std::pair<T, size_t>> sorted;
-                for (size_t i = 0; i < c->size(); ++i) {
-                    sorted.push_back({(*c)[i], i});
-                }
-                std::sort(sorted.begin(), sorted.end());
-
-                indices.resize(c->size());
-                size_t idx = 0;
-                size_t left = 0;
-                size_t right = sorted.size() - 1;
-                
-                while (left <= right) {
-                    if (left == right) {
-                        indices[idx] = sorted[left].second;
-                        break;
-                    }
-                    indices[idx++] = sorted[left++].second;
-                    indices[idx++] = sorted[right--].second;
-                }
+            Derived& operator+=(difference_type n) {
+                advance(n);
+                return self();
             }
 
             /**
-             * @brief Copy constructor
-             * @param other Iterator to copy from
-             * Time Complexity: O(n) for indices vector copy
-             */
-            SideCrossOrder(const SideCrossOrder& other) = default;
-
-            /**
-             * @brief Assignment operator
-             * @param other Iterator to assign from
+             * @brief Moves the iterator backward by n positions
+             * @param n Signed number of steps, negative moves forward
              * @return Reference to this iterator
-             * Time Complexity: O(n) for vector assignment
+             * Time Complexity: O(1)
              */
-            SideCrossOrder& operator=(const SideCrossOrder& other) {
-                if (this != &other) {
-                    container = other.container;
-                    current = other.current;
-                    is_end = other.is_end;
-                    indices = other.indices;
-                }
-                return *this;
+            Derived& operator-=(difference_type n) {
+                advance(n == std::numeric_limits<difference_type>::min() ? std::numeric_limits<difference_type>::max() : -n);
+                return self();
             }
 
+            friend Derived operator+(Derived it, difference_type n) { return it += n; }
+            friend Derived operator+(difference_type n, Derived it) { return it += n; }
+            friend Derived operator-(Derived it, difference_type n) { return it -= n; }
+
             /**
-             * @brief Equality comparison operator
-             * @param other Iterator to compare with
-             * @return true if iterators are at the same position or both at end
+             * @brief Distance between two iterators over the same container
+             * @return Number of increments needed to move b to a
              * Time Complexity: O(1)
              */
-            bool operator==(const SideCrossOrder& other) const {
-                if (is_end && other.is_end) return true;
-                if (is_end || other.is_end) return false;
-                return current == other.current;
+            friend difference_type operator-(const Derived& a, const Derived& b) {
+                return static_cast<difference_type>(a.position()) - static_cast<difference_type>(b.position());
             }
 
             /**
-             * @brief Inequality comparison operator
-             * @param other Iterator to compare with
-             * @return true if iterators are not at the same position
+             * @brief Comparison operators
+             * @return Comparison of the two traversal positions; all end iterators are equal
              * Time Complexity: O(1)
              */
-            bool operator!=(const SideCrossOrder& other) const {
-                return !(*this == other);
+            friend bool operator==(const Derived& a, const Derived& b) { return a.position() == b.position(); }
+            friend bool operator!=(const Derived& a, const Derived& b) { return !(a == b); }
+            friend bool operator<(const Derived& a, const Derived& b) { return a.position() < b.position(); }
+            friend bool operator>(const Derived& a, const Derived& b) { return b < a; }
+            friend bool operator<=(const Derived& a, const Derived& b) { return !(b < a); }
+            friend bool operator>=(const Derived& a, const Derived& b) { return !(a < b); }
+
+            /**
+             * @brief Get iterator to the beginning
+             * @return Iterator pointing to the first element of this order
+             * Time Complexity: O(1), sorting is deferred to dereference
+             */
+            Derived begin() const {
+                return Derived(container, false);
             }
 
             /**
-             * @brief Dereference operator
-             * @return Const reference to the current element
-             * @throws std::out_of_range if iterator is at end or invalid position
+             * @brief Get iterator to the end
+             * @return Iterator pointing past the last element of this order
              * Time Complexity: O(1)
              */
-            const T& operator*() const {
-                if (is_end || current >= container->size()) {
-                    throw std::out_of_range("Iterator out of bounds");
-                }
-                return (*container)[indices[current]];
+            Derived end() const {
+                return Derived(container, true);
             }
+        };
+
+        /**
+         * @brief Regular order iterator
+         * Iterates through elements in their original insertion order
+         * Example: For container [1,4,2,3], iteration order is 1,4,2,3
+         *
+         * This iterator maintains the order in which elements were added to the container.
+         * All iterator operations are const and will not modify the container.
+         * Time Complexity: O(1) for all operations
+         */
+        class Order : public OrderIterator<Order> {
+        private:
+            friend class OrderIterator<Order>;
 
             /**
-             * @brief Pre-increment operator
-             * @return Reference to this iterator after incrementing
+             * @brief Maps a traversal position to an element index
              * Time Complexity: O(1)
              */
-            SideCrossOrder& operator++() {
-                if (!is_end) {
-                    ++current;
-                    if (current >= indices.size()) {
-                        is_end = true;
-                        current = indices.size();
-                    }
-                }
-                return *this;
+            size_t element_index(size_t position) const {
+                return position;
             }
 
+        public:
+            Order() = default;
+
             /**
-             * @brief Post-increment operator
-             * @return Copy of iterator before incrementing
+             * @brief Constructor
+             * @param c Pointer to the container to iterate over
+             * @param end If true, creates an end iterator
              * Time Complexity: O(1)
              */
-            SideCrossOrder operator++(int) {
-                SideCrossOrder temp = *this;
-                ++(*this);
-                return temp;
-            }
+            explicit Order(const MyContainer* c, bool end = false) : OrderIterator<Order>(c, end) {}
+        };
+
+        /**
+         * @brief Reverse order iterator
+         * Iterates through elements in reverse of insertion order
+         * Example: For container [1,4,2,3], iteration order is 3,2,4,1
+         *
+         * This iterator traverses the container from last element to first.
+         * All iterator operations are const and will not modify the container.
+         * Time Complexity: O(1) for all operations
+         */
+        class ReverseOrder : public OrderIterator<ReverseOrder> {
+        private:
+            friend class OrderIterator<ReverseOrder>;
 
             /**
-             * @brief Get iterator to the beginning
-             * @return Iterator pointing to the first element in side-cross order
-             * Time Complexity: O(n log n) for sorting and preparing indices
+             * @brief Maps a traversal position to an element index
+             * Time Complexity: O(1)
              */
-            SideCrossOrder begin() const { 
-                return SideCrossOrder(container); 
+            size_t element_index(size_t position) const {
+                return this->container->size() - 1 - position;
             }
 
+        public:
+            ReverseOrder() = default;
+
             /**
-             * @brief Get iterator to the end
-             * @return Iterator pointing past the last element
+             * @brief Constructor
+             * @param c Pointer to the container to iterate over
+             * @param end If true, creates an end iterator
              * Time Complexity: O(1)
              */
-            SideCrossOrder end() const {
-                return SideCrossOrder(container, true);
-            }
+            explicit ReverseOrder(const MyContainer* c, bool end = false) : OrderIterator<ReverseOrder>(c, end) {}
         };
 
         /**
-         * @brief Middle out order iterator
-         * Iterates from middle element outward
-         * Example: For container [1,2,3,4], iteration order is 2,3,1,4
-         * For odd size: middle element first, then alternating left and right
-         * For even size: left-middle first, then right-middle, then alternating outward
-         * 
-         * This iterator provides traversal starting from the middle elements.
-         * Creates and maintains a pre-calculated traversal order for efficient iteration.
-         * Time Complexity: O(n) for construction, O(1) for iteration operations
+         * @brief Ascending order iterator
+         * Iterates through elements from smallest to largest
+         * Example: For container [4,1,3,2], iteration order is 1,2,3,4
+         *
+         * This iterator provides sorted access to elements in ascending order.
+         * Reads ranks from the container's shared sorted permutation, which is only
+         * sorted on dereference, so end iterators and unread views do not sort.
+         * Being random access, the view works with std::lower_bound and friends.
+         * Time Complexity: O(1) for construction and copying, sorting cost is paid
+         * on dereference (see SortMode), O(1) for iteration operations
          */
-        class MiddleOutOrder {
+        class AscendingOrder : public OrderIterator<AscendingOrder> {
         private:
-            const MyContainer* container; ///< Pointer to the container being iterated
-            std::vector<size_t> indices;  ///< Pre-calculated iteration order
-            size_t current;               ///< Current position in indices
-            bool is_end;                  ///< Flag indicating if iterator is at end position
+            friend class OrderIterator<AscendingOrder>;
+
+            /**
+             * @brief Maps a traversal position to an element index
+             * Time Complexity: O(1) once the rank is sorted
+             */
+            size_t element_index(size_t position) const {
+                return this->container->sorted_at(position);
+            }
 
         public:
+            AscendingOrder() = default;
+
             /**
              * @brief Constructor
              * @param c Pointer to the container to iterate over
              * @param end If true, creates an end iterator
-             * Time Complexity: O(n) for preparing indices
+             * Time Complexity: O(1), sorting is deferred to dereference
              */
-            explicit MiddleOutOrder(const MyContainer* c, bool end = false) : 
-                container(c), 
-                current(end ? c->size() : 0),
-                is_end(end || c->size() == 0) {
-                
-                if (c->size() == 0) return;
-
-                indices.resize(c->size());
-                size_t mid = c->size() / 2;
-                size_t index = 0;
-                
-                // Different handling for even and odd sized containers
-                if (c->size() % 2 == 0) {
-                    indices[index++] = mid - 1;  // Left middle
-                    indices[index++] = mid;      // Right middle
-                    
-                    // Alternating outward from middle
-                    for (size_t i = 1; index < c->size(); ++i) {
-                        if (mid - 1 - i >= 0 && index < c->size()) {
-                            indices[index++] = mid - 1 - i;
-                        }
-                        if (mid + i < c->size() && index < c->size()) {
-                            indices[index++] = mid + i;
-                        }
-                    }
-                }
-                else {
-                    indices[index++] = mid;      // Middle element
-                    
-                    // Alternating left and right from middle
-                    for (size_t i = 1; index < c->size(); ++i) {
-                        if (mid - i >= 0 && index < c->size()) {
-                            indices[index++] = mid - i;
-                        }
-                        if (mid + i < c->size() && index < c->size()) {
-                            indices[index++] = mid + i;
-                        }
-                    }
-                }
-            }
+            explicit AscendingOrder(const MyContainer* c, bool end = false) : OrderIterator<AscendingOrder>(c, end) {}
+        };
 
-            /**
-             * @brief Copy constructor
-             * @param other Iterator to copy from
-             * Time Complexity: O(n) for vector copy
-             */
-            MiddleOutOrder(const MiddleOutOrder& other) = default;
+        /**
+         * @brief Descending order iterator
+         * Iterates through elements from largest to smallest
+         * Example: For container [4,1,3,2], iteration order is 4,3,2,1
+         *
+         * This iterator provides sorted access to elements in descending order.
+         * Reads the container's shared ascending permutation from its back; ranks
+         * are only sorted on dereference, so end iterators and unread views do not sort.
+         * Time Complexity: O(1) for construction and copying, sorting cost is paid
+         * on dereference (see SortMode), O(1) for iteration operations
+         */
+        class DescendingOrder : public OrderIterator<DescendingOrder> {
+        private:
+            friend class OrderIterator<DescendingOrder>;
 
             /**
-             * @brief Copy constructor
-             * @param other Iterator to copy from
-             * Time Complexity: O(n) for indices vector copy
+             * @brief Maps a traversal position to an element index
+             * Time Complexity: O(1) once the rank is sorted
              */
-            MiddleOutOrder& operator=(const MiddleOutOrder& other) {
-                if (this != &other) {
-                    container = other.container;
-                    current = other.current;
-                    is_end = other.is_end;
-                    indices = other.indices;
-                }
-                return *this;
+            size_t element_index(size_t position) const {
+                return this->container->sorted_at(this->container->size() - 1 - position);
             }
 
+        public:
+            DescendingOrder() = default;
+
             /**
-             * @brief Equality comparison operator
-             * @param other Iterator to compare with
-             * @return true if iterators are at the same position or both at end
-             * Time Complexity: O(1)
+             * @brief Constructor
+             * @param c Pointer to the container to iterate over
+             * @param end If true, creates an end iterator
+             * Time Complexity: O(1), sorting is deferred to dereference
              */
-            bool operator==(const MiddleOutOrder& other) const {
-                if (is_end && other.is_end) return true;
-                if (is_end || other.is_end) return false;
-                return current == other.current;
-            }
+            explicit DescendingOrder(const MyContainer* c, bool end = false) : OrderIterator<DescendingOrder>(c, end) {}
+        };
+
+        /**
+         * @brief Side cross order iterator
+         * Iterates alternating between smallest and largest remaining elements
+         * Example: For container [4,1,3,2], iteration order is 1,4,2,3
+         *
+         * This iterator provides alternating access between minimum and maximum elements.
+         * Walks the container's shared ascending permutation with two pointers, one
+         * from each end; ranks are only sorted on dereference, so end iterators and
+         * unread views do not sort. Elements themselves are never copied.
+         * Time Complexity: O(1) for construction and copying, sorting cost is paid
+         * on dereference (see SortMode), O(1) for iteration operations
+         */
+        class SideCrossOrder : public OrderIterator<SideCrossOrder> {
+        private:
+            friend class OrderIterator<SideCrossOrder>;
 
             /**
-             * @brief Inequality comparison operator
-             * @param other Iterator to compare with
-             * @return true if iterators are not at the same position
-             * Time Complexity: O(1)
+             * @brief Maps a traversal position to an element index
+             * Time Complexity: O(1) once the rank is sorted
              */
-            bool operator!=(const MiddleOutOrder& other) const {
-                return !(*this == other);
+            size_t element_index(size_t position) const {
+                // Even positions advance the left pointer, odd positions the right one
+                size_t rank = position % 2 == 0 ? position / 2 : this->container->size() - 1 - position / 2;
+                return this->container->sorted_at(rank);
             }
 
+        public:
+            SideCrossOrder() = default;
+
             /**
-             * @brief Dereference operator
-             * @return Const reference to the current element
-             * @throws std::out_of_range if iterator is at end or invalid position
-             * Time Complexity: O(1)
+             * @brief Constructor
+             * @param c Pointer to the container to iterate over
+             * @param end If true, creates an end iterator
+             * Time Complexity: O(1), sorting is deferred to dereference
              */
-            const T& operator*() const {
-                if (is_end || current >= container->size()) {
-                    throw std::out_of_range("Iterator out of bounds");
-                }
-                return (*container)[indices[current]];
-            }
+            explicit SideCrossOrder(const MyContainer* c, bool end = false) : OrderIterator<SideCrossOrder>(c, end) {}
+        };
+
+        /**
+         * @brief Middle out order iterator
+         * Iterates from middle element outward
+         * Example: For container [1,2,3,4], iteration order is 2,3,1,4
+         * For odd size: middle element first, then alternating left and right
+         * For even size: left-middle first, then right-middle, then alternating outward
+         *
+         * This iterator provides traversal starting from the middle elements.
+         * Each position is mapped to its element index arithmetically, so no
+         * traversal table is allocated.
+         * Time Complexity: O(1) for all operations, O(1) memory
+         */
+        class MiddleOutOrder : public OrderIterator<MiddleOutOrder> {
+        private:
+            friend class OrderIterator<MiddleOutOrder>;
 
             /**
-             * @brief Pre-increment operator
-             * @return Reference to this iterator after incrementing
+             * @brief Maps a traversal position to an element index
+             * @param k Position in middle-out order
+             * @param n Container size
+             * @return Index of the element visited at position k
              * Time Complexity: O(1)
+             *
+             * Odd sizes visit mid, mid-1, mid+1, mid-2, ...
+             * Even sizes visit mid-1, mid, mid-2, mid+1, ...
              */
-            MiddleOutOrder& operator++() {
-                if (!is_end) {
-                    ++current;
-                    if (current >= indices.size()) {
-                        is_end = true;
-                        current = indices.size();
-                    }
+            static size_t index_at(size_t k, size_t n) {
+                size_t mid = n / 2;
+                if (n % 2 == 0) {
+                    return k % 2 == 0 ? mid - 1 - k / 2 : mid + k / 2;
                 }
-                return *this;
+                return k % 2 == 0 ? mid + k / 2 : mid - (k + 1) / 2;
             }
 
-                        /**
-             * @brief Post-increment operator
-             * @return Copy of iterator before incrementing
-             * Time Complexity: O(1)
-             */
-            MiddleOutOrder operator++(int) {
-                MiddleOutOrder temp = *this;
-                ++(*this);
-                return temp;
+            size_t element_index(size_t position) const {
+                return index_at(position, this->container->size());
             }
 
-            /**
-             * @brief Get iterator to the beginning
-             * @return Iterator pointing to the middle element(s)
-             * Time Complexity: O(n) for preparing indices
-             */
-            MiddleOutOrder begin() const {
-                return MiddleOutOrder(container);
-            }
+        public:
+            MiddleOutOrder() = default;
 
             /**
-             * @brief Get iterator to the end
-             * @return Iterator pointing past the last element
+             * @brief Constructor
+             * @param c Pointer to the container to iterate over
+             * @param end If true, creates an end iterator
              * Time Complexity: O(1)
              */
-            MiddleOutOrder end() const {
-                return MiddleOutOrder(container, true);
-            }
+            explicit MiddleOutOrder(const MyContainer* c, bool end = false) : OrderIterator<MiddleOutOrder>(c, end) {}
         };
 
     public:
@@ -1036,29 +1967,182 @@ namespace containers {
         /**
          * @brief Get iterator for ascending order traversal
          * @return AscendingOrder iterator
-         * Time Complexity: O(n log n)
+         * Time Complexity: O(1), sorting is deferred to dereference
          */
         AscendingOrder ascending_order() const { return AscendingOrder(this); }
 
+        /**
+         * @brief Get iterator for ascending order traversal, sorting in parallel first
+         * @param policy Parallel execution policy, e.g. execution::par or execution::par(8)
+         * @return AscendingOrder iterator over the fully sorted permutation
+         * Time Complexity: O((n / p) log(n / p) + (n / p) log p) with p threads
+         */
+        AscendingOrder ascending_order(const execution::parallel_policy& policy) const {
+            sort_all(policy);
+            return AscendingOrder(this);
+        }
+
         /**
          * @brief Get iterator for descending order traversal
          * @return DescendingOrder iterator
-         * Time Complexity: O(n log n)
+         * Time Complexity: O(1), sorting is deferred to dereference
          */
         DescendingOrder descending_order() const { return DescendingOrder(this); }
 
+        /**
+         * @brief Get iterator for descending order traversal, sorting in parallel first
+         * @param policy Parallel execution policy, e.g. execution::par or execution::par(8)
+         * @return DescendingOrder iterator over the fully sorted permutation
+         * Time Complexity: O((n / p) log(n / p) + (n / p) log p) with p threads
+         */
+        DescendingOrder descending_order(const execution::parallel_policy& policy) const {
+            sort_all(policy);
+            return DescendingOrder(this);
+        }
+
         /**
          * @brief Get iterator for side-cross order traversal
          * @return SideCrossOrder iterator
-         * Time Complexity: O(n log n)
+         * Time Complexity: O(1), sorting is deferred to dereference
          */
         SideCrossOrder side_cross_order() const { return SideCrossOrder(this); }
 
+        /**
+         * @brief Get iterator for side-cross order traversal, sorting in parallel first
+         * @param policy Parallel execution policy, e.g. execution::par or execution::par(8)
+         * @return SideCrossOrder iterator over the fully sorted permutation
+         * Time Complexity: O((n / p) log(n / p) + (n / p) log p) with p threads
+         */
+        SideCrossOrder side_cross_order(const execution::parallel_policy& policy) const {
+            sort_all(policy);
+            return SideCrossOrder(this);
+        }
+
         /**
          * @brief Get iterator for middle-out order traversal
          * @return MiddleOutOrder iterator
-         * Time Complexity: O(n)
+         * Time Complexity: O(1)
          */
         MiddleOutOrder middle_out_order() const { return MiddleOutOrder(this); }
     };
+
+    /**
+     * @brief MyContainer keeping up to N elements, and their sorted permutation, inside the object
+     * @tparam T The type of elements to store
+     * @tparam N Number of elements stored without a heap allocation, at most 65536
+     * @tparam Allocator Allocator used once the container grows past N
+     *
+     * Supports every operation and iteration order of MyContainer. Growing past
+     * N moves the elements to the heap as std::vector would; SortMode::Maintained
+     * and the hash index always use allocator memory.
+     */
+    template<typename T, size_t N, typename Allocator = std::allocator<T>>
+    using SmallContainer = MyContainer<T, Allocator, detail::SmallVector<T, N, Allocator>>;
+
+    /**
+     * @brief MyContainer storing its elements in fixed-size chunks that never move
+     * @tparam T The type of elements to store
+     * @tparam Allocator Allocator for the chunks and internal buffers
+     * @tparam Chunk Elements per chunk, a power of two; about 64 KiB by default
+     *
+     * Growth allocates one chunk at a time instead of reallocating, so very
+     * large containers never copy their elements or need twice their memory
+     * while growing, and references to elements stay valid as elements are
+     * added. Indexed access stays O(1) through the chunk directory, and every
+     * operation and iteration order of MyContainer is supported.
+     */
+    template<typename T, typename Allocator = std::allocator<T>,
+             size_t Chunk = detail::default_chunk_elements(sizeof(T))>
+    using SegmentedContainer = MyContainer<T, Allocator, detail::SegmentedVector<T, Chunk, Allocator>>;
+
+#if __has_include(<sys/mman.h>)
+    /**
+     * @brief MyContainer keeping its elements in a memory-mapped file
+     * @tparam T The type of elements to store, trivially copyable
+     *
+     * Default-constructed containers use anonymous mappings; open_mapped()
+     * attaches one to a file instead. Every iteration order reads the mapped
+     * elements in place, so reopening a file needs no deserialization. The
+     * sorted permutation and the other internal buffers stay on the heap.
+     */
+    template<typename T>
+    using MappedContainer = MyContainer<T, std::allocator<T>, detail::MappedVector<T>>;
+
+    /**
+     * @brief Opens or creates a file holding a MappedContainer's elements
+     * @tparam T The type of elements stored in the file
+     * @param path File to map; created empty when missing
+     * @return Container whose elements are those already in the file
+     * @throws std::system_error if the file cannot be opened or mapped
+     * @throws std::runtime_error if the file does not hold elements of T's size
+     * Time Complexity: O(1), pages are read as they are first touched
+     *
+     * Changes are written back by the operating system; call
+     * storage().sync() to force them to disk.
+     */
+    template<typename T>
+    MappedContainer<T> open_mapped(const std::string& path) {
+        return MappedContainer<T>(detail::MappedVector<T>(path));
+    }
+
+#if __has_include(<sys/uio.h>)
+    /**
+     * @brief Loads a file written by save() by mapping it instead of reading it
+     * @tparam T The type of elements stored in the file, trivially copyable
+     * @param path File to map
+     * @return Container whose elements are the file's pages, mapped copy-on-write
+     * @throws std::system_error if the file cannot be opened or mapped
+     * @throws std::runtime_error if the file is not valid for T
+     * Time Complexity: O(n) to verify the checksum, with no element copies
+     *
+     * The file is never modified. Writing to an element copies only its
+     * page, and the first growth moves the elements to anonymous memory.
+     */
+    template<typename T>
+    MappedContainer<T> load_mapped(const std::string& path) {
+        detail::FileCloser file{::open(path.c_str(), O_RDONLY)};
+        if (file.fd < 0) throw std::system_error(errno, std::generic_category(), "open");
+        detail::BinaryHeader header;
+        detail::read_exact(file.fd, &header, sizeof(header));
+        detail::check_header<T>(header);
+        detail::check_available(file.fd, header.payload_bytes);
+        detail::MappedVector<T> storage = detail::MappedVector<T>::adopt_private(
+            file.fd, static_cast<size_t>(header.count));
+        detail::Checksum checksum;
+        checksum.update(storage.begin(), storage.size() * sizeof(T));
+        if (checksum.value() != header.checksum) {
+            throw std::runtime_error("Checksum mismatch");
+        }
+        return MappedContainer<T>(std::move(storage));
+    }
+#endif
+#endif
+
+    namespace pmr {
+        /**
+         * @brief MyContainer drawing its memory from a std::pmr::memory_resource
+         * @tparam T The type of elements to store
+         *
+         * Pass the resource to a constructor, e.g.
+         * containers::pmr::MyContainer<int> c(&arena), and release the arena
+         * once the container is gone.
+         */
+        template<typename T>
+        using MyContainer = containers::MyContainer<T, std::pmr::polymorphic_allocator<T>>;
+
+        /**
+         * @brief SmallContainer spilling into a std::pmr::memory_resource
+         * @tparam T The type of elements to store
+         * @tparam N Number of elements stored inline
+         */
+        template<typename T, size_t N>
+        using SmallContainer = containers::SmallContainer<T, N, std::pmr::polymorphic_allocator<T>>;
+
+        /**
+         * @brief SegmentedContainer drawing its chunks from a std::pmr::memory_resource
+         * @tparam T The type of elements to store
+         */
+        template<typename T>
+        using SegmentedContainer = containers::SegmentedContainer<T, std::pmr::polymorphic_allocator<T>>;
+    }
 }
\ No newline at end of file
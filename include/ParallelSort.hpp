@@ -0,0 +1,211 @@
+// author: avivoz4@gmail.com
+
+/**
+ * @file ParallelSort.hpp
+ * @brief Execution policy and multiway merge sort used to build sorted views in parallel
+ * @author Aviv Oz
+ * @email avivoz4@gmail.com
+ *
+ * The range is cut into one chunk per worker, each chunk is sorted on its own
+ * thread, and the sorted chunks are merged pairwise in rounds. Every round
+ * splits each pair's output into equal slices at merge-path boundaries, so
+ * all threads share the merging even in the last round, where a single pair
+ * is left. As long as the comparison is a strict total order the result is
+ * identical to a sequential sort of the whole range.
+ */
+
+#pragma once
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <exception>
+#include <algorithm>
+#include <iterator>
+#include <memory>
+
+namespace containers {
+namespace execution {
+
+    /**
+     * @brief Requests that a sorted view be built on several threads
+     *
+     * Use containers::execution::par for one thread per hardware core, or
+     * containers::execution::par(n) for exactly n threads.
+     */
+    struct parallel_policy {
+        unsigned threads = 0; ///< Worker count, 0 means std::thread::hardware_concurrency()
+
+        /**
+         * @brief Returns a policy with an explicit thread count
+         * @param count Number of worker threads
+         * @return Policy using count threads
+         */
+        constexpr parallel_policy operator()(unsigned count) const {
+            return parallel_policy{count};
+        }
+
+        /**
+         * @brief Resolves the number of threads to use
+         * @return threads, or the hardware concurrency (at least 1) when threads is 0
+         */
+        unsigned thread_count() const {
+            if (threads != 0) return threads;
+            unsigned hw = std::thread::hardware_concurrency();
+            return hw == 0 ? 1 : hw;
+        }
+    };
+
+    inline constexpr parallel_policy par{}; ///< Parallel policy using every hardware thread
+}
+
+namespace detail {
+
+    /**
+     * @brief Joins every started thread of a pool when leaving scope
+     */
+    struct ThreadJoiner {
+        std::vector<std::thread>& pool;
+        ~ThreadJoiner() {
+            for (std::thread& t : pool) {
+                if (t.joinable()) t.join();
+            }
+        }
+    };
+
+    /**
+     * @brief Runs tasks 0..count-1 on a fixed group of worker threads
+     * @param count Number of tasks
+     * @param threads Maximum number of threads, the calling thread included
+     * @param task Callable taking the task number
+     * @throws The first exception thrown by a task, once every thread has stopped,
+     * or std::system_error if a thread cannot be started
+     * Time Complexity: O(count) task invocations
+     *
+     * Workers pull task numbers from a shared counter, so uneven tasks are
+     * balanced without a queue. The calling thread works too and the call
+     * returns once every task has finished. After a task throws, no further
+     * tasks are started.
+     */
+    template<typename Task>
+    void run_tasks(size_t count, unsigned threads, Task task) {
+        std::atomic<size_t> next(0);
+        std::exception_ptr failure;
+        std::mutex failure_lock;
+        auto worker = [&]() {
+            try {
+                for (size_t i = next++; i < count; i = next++) {
+                    task(i);
+                }
+            } catch (...) {
+                next = count;
+                std::lock_guard<std::mutex> guard(failure_lock);
+                if (!failure) failure = std::current_exception();
+            }
+        };
+
+        size_t extra = std::min<size_t>(threads, count);
+        extra = extra == 0 ? 0 : extra - 1;
+        std::vector<std::thread> pool;
+        pool.reserve(extra);
+        {
+            ThreadJoiner joiner{pool};
+            try {
+                for (size_t t = 0; t < extra; ++t) {
+                    pool.emplace_back(worker);
+                }
+            } catch (...) {
+                next = count;
+                throw;
+            }
+            worker();
+        }
+        if (failure) std::rethrow_exception(failure);
+    }
+
+    /**
+     * @brief Finds how many elements of a come first in the merge of two sorted ranges
+     * @param a First sorted range, preferred on ties as by std::merge
+     * @param na Length of a
+     * @param b Second sorted range
+     * @param nb Length of b
+     * @param k Number of merged elements, at most na + nb
+     * @param less Strict weak order on the elements
+     * @return i such that the first k merged elements are a[0, i) and b[0, k - i)
+     * Time Complexity: O(log(min(na, nb))) comparisons
+     */
+    template<typename It, typename Compare>
+    size_t merge_split(It a, size_t na, It b, size_t nb, size_t k, Compare less) {
+        size_t lo = k > nb ? k - nb : 0;
+        size_t hi = std::min(k, na);
+        while (lo < hi) {
+            size_t i = lo + (hi - lo) / 2;
+            if (!less(b[k - i - 1], a[i])) {
+                lo = i + 1;
+            } else {
+                hi = i;
+            }
+        }
+        return lo;
+    }
+
+    /**
+     * @brief Sorts a range with one chunk per thread followed by parallel merge rounds
+     * @param first Iterator to the first element
+     * @param last Iterator past the last element
+     * @param less Strict total order on the elements
+     * @param sort_chunk Callable sorting a sub-range [chunk_first, chunk_last)
+     * @param threads Number of threads to use
+     * @param alloc Allocator the merge buffers are obtained from
+     * @throws Whatever less or sort_chunk throws, after every thread has stopped;
+     * the range then holds its original elements in unspecified order
+     * Time Complexity: O((n / p) log(n / p) + (n / p) log p) with p threads, O(n) extra memory
+     */
+    template<typename RandomIt, typename Compare, typename ChunkSort, typename Alloc = std::allocator<size_t>>
+    void parallel_sort(RandomIt first, RandomIt last, Compare less, ChunkSort sort_chunk, unsigned threads,
+                       const Alloc& alloc = Alloc()) {
+        using Value = typename std::iterator_traits<RandomIt>::value_type;
+        using ValueAlloc = typename std::allocator_traits<Alloc>::template rebind_alloc<Value>;
+        const size_t n = static_cast<size_t>(last - first);
+        const size_t chunks = std::max<size_t>(1, std::min<size_t>(threads, n));
+        if (chunks < 2) {
+            sort_chunk(first, last);
+            return;
+        }
+
+        using BoundAlloc = typename std::allocator_traits<Alloc>::template rebind_alloc<size_t>;
+        std::vector<size_t, BoundAlloc> bounds(chunks + 1, 0, BoundAlloc(alloc));
+        for (size_t c = 0; c <= chunks; ++c) {
+            bounds[c] = n * c / chunks;
+        }
+        run_tasks(chunks, threads, [&](size_t c) {
+            sort_chunk(first + bounds[c], first + bounds[c + 1]);
+        });
+
+        std::vector<Value, ValueAlloc> data(first, last, ValueAlloc(alloc));
+        std::vector<Value, ValueAlloc> buffer(n, ValueAlloc(alloc));
+        for (size_t width = 1; width < chunks; width *= 2) {
+            size_t pairs = (chunks + 2 * width - 1) / (2 * width);
+            size_t slices = (threads + pairs - 1) / pairs;
+            run_tasks(pairs * slices, threads, [&](size_t task) {
+                size_t p = task / slices;
+                size_t s = task % slices;
+                size_t lo = bounds[p * 2 * width];
+                size_t mid = bounds[std::min(chunks, p * 2 * width + width)];
+                size_t hi = bounds[std::min(chunks, p * 2 * width + 2 * width)];
+                auto a = data.begin() + lo;
+                auto b = data.begin() + mid;
+                size_t na = mid - lo;
+                size_t nb = hi - mid;
+                size_t k0 = (hi - lo) * s / slices;
+                size_t k1 = (hi - lo) * (s + 1) / slices;
+                size_t i0 = merge_split(a, na, b, nb, k0, less);
+                size_t i1 = merge_split(a, na, b, nb, k1, less);
+                std::merge(a + i0, a + i1, b + (k0 - i0), b + (k1 - i1), buffer.begin() + lo + k0, less);
+            });
+            data.swap(buffer);
+        }
+        std::copy(data.begin(), data.end(), first);
+    }
+}
+}
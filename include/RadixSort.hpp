@@ -0,0 +1,139 @@
+// author: avivoz4@gmail.com
+
+/**
+ * @file RadixSort.hpp
+ * @brief LSD radix sort of index permutations for arithmetic element types
+ * @author Aviv Oz
+ * @email avivoz4@gmail.com
+ *
+ * Sorted views of MyContainer order element indices by value. For integral
+ * and floating point elements the values are mapped to unsigned keys whose
+ * unsigned order matches the element order, and the indices are sorted with
+ * a stable least-significant-digit radix sort instead of a comparison sort.
+ */
+
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+
+namespace containers {
+namespace detail {
+
+    /**
+     * @brief Unsigned integer with the same width as T
+     * @tparam T Arithmetic type of 1, 2, 4 or 8 bytes
+     */
+    template<typename T>
+    using radix_key_t = std::conditional_t<sizeof(T) == 1, uint8_t,
+                        std::conditional_t<sizeof(T) == 2, uint16_t,
+                        std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>>>;
+
+    /**
+     * @brief Whether elements of type T can be ordered by radix_key()
+     *
+     * Covers integral types and float/double. long double is excluded because
+     * its padding bytes are not part of the value.
+     */
+    template<typename T>
+    struct is_radix_sortable : std::integral_constant<bool,
+        (std::is_integral<T>::value || std::is_same<T, float>::value || std::is_same<T, double>::value) &&
+        (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8)> {};
+
+    /**
+     * @brief Maps a value to an unsigned key with the same ordering
+     * @param value The element value
+     * @return Key such that a < b implies radix_key(a) < radix_key(b)
+     * Time Complexity: O(1)
+     *
+     * Signed integers have their sign bit flipped. Floating point values have
+     * all bits flipped when negative and only the sign bit flipped otherwise;
+     * -0.0 is folded onto +0.0 so that the two compare equal, as with operator<.
+     */
+    template<typename T>
+    radix_key_t<T> radix_key(T value) {
+        using Key = radix_key_t<T>;
+        constexpr Key sign_bit = Key(1) << (sizeof(T) * 8 - 1);
+
+        if constexpr (std::is_floating_point<T>::value) {
+            if (value == T(0)) value = T(0);
+            Key bits;
+            std::memcpy(&bits, &value, sizeof(T));
+            return (bits & sign_bit) ? Key(~bits) : Key(bits ^ sign_bit);
+        } else if constexpr (std::is_signed<T>::value) {
+            return Key(static_cast<Key>(value) ^ sign_bit);
+        } else {
+            return static_cast<Key>(value);
+        }
+    }
+
+    /**
+     * @brief Stable LSD radix sort of indices by key
+     * @tparam Key Unsigned key type
+     * @param first Iterator to the first index
+     * @param last Iterator past the last index
+     * @param key_of Callable returning the Key of an index
+     * @param alloc Allocator the scratch buffers are obtained from
+     * Time Complexity: O(n * sizeof(Key)), O(n) extra memory
+     *
+     * Sorts 11 bits per pass (8 for one-byte keys), skipping passes in which
+     * every key shares the same digit. Indices with equal keys keep their
+     * relative input order, so an input in ascending index order yields ties
+     * broken by position. Each key is buffered next to an index of the input's
+     * own type, so narrow index types keep the scratch buffers small too.
+     */
+    template<typename Key, typename RandomIt, typename KeyOf, typename Alloc = std::allocator<size_t>>
+    void radix_sort_indices(RandomIt first, RandomIt last, KeyOf key_of, const Alloc& alloc = Alloc()) {
+        constexpr size_t radix_bits = sizeof(Key) == 1 ? 8 : 11;
+        constexpr size_t buckets = size_t(1) << radix_bits;
+        constexpr size_t digits = (sizeof(Key) * 8 + radix_bits - 1) / radix_bits;
+        using Index = typename std::iterator_traits<RandomIt>::value_type;
+        const size_t n = static_cast<size_t>(last - first);
+        if (n < 2) return;
+
+        struct Entry {
+            Key key;
+            Index index;
+        };
+        using EntryAlloc = typename std::allocator_traits<Alloc>::template rebind_alloc<Entry>;
+        using CountAlloc = typename std::allocator_traits<Alloc>::template rebind_alloc<size_t>;
+        std::vector<Entry, EntryAlloc> entries(n, EntryAlloc(alloc));
+        std::vector<Entry, EntryAlloc> buffer(n, EntryAlloc(alloc));
+
+        std::vector<size_t, CountAlloc> counts(digits * buckets, 0, CountAlloc(alloc));
+        for (size_t i = 0; i < n; ++i) {
+            Index index = first[i];
+            Key key = key_of(static_cast<size_t>(index));
+            entries[i] = Entry{key, index};
+            for (size_t d = 0; d < digits; ++d) {
+                ++counts[d * buckets + ((key >> (d * radix_bits)) & (buckets - 1))];
+            }
+        }
+
+        for (size_t d = 0; d < digits; ++d) {
+            size_t* count = counts.data() + d * buckets;
+            const size_t shift = d * radix_bits;
+            if (count[(entries[0].key >> shift) & (buckets - 1)] == n) continue;
+
+            size_t offset = 0;
+            for (size_t b = 0; b < buckets; ++b) {
+                size_t c = count[b];
+                count[b] = offset;
+                offset += c;
+            }
+            for (size_t i = 0; i < n; ++i) {
+                buffer[count[(entries[i].key >> shift) & (buckets - 1)]++] = entries[i];
+            }
+            entries.swap(buffer);
+        }
+
+        for (size_t i = 0; i < n; ++i) {
+            first[i] = entries[i].index;
+        }
+    }
+}
+}
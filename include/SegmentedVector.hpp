@@ -0,0 +1,358 @@
+// author: avivoz4@gmail.com
+
+/**
+ * @file SegmentedVector.hpp
+ * @brief Chunked element storage behind SegmentedContainer
+ * @author Aviv Oz
+ * @email avivoz4@gmail.com
+ *
+ * Elements live in fixed-size chunks reached through a directory of chunk
+ * pointers. Growing allocates one more chunk and never moves an element, so
+ * a container of many gigabytes grows without copying itself or briefly
+ * holding two copies, and element addresses stay valid as elements are
+ * added. Indexing is a shift, a mask and one extra load. Only the subset of
+ * the std::vector interface that MyContainer uses is provided.
+ */
+
+#pragma once
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <utility>
+#include <iterator>
+#include <algorithm>
+#include <type_traits>
+#include <initializer_list>
+
+namespace containers {
+namespace detail {
+
+    /**
+     * @brief Largest power of two not above max(1, 65536 / size)
+     * @param size Size of one element in bytes
+     * @return Elements per chunk, so chunks of small elements span about 64 KiB
+     */
+    constexpr size_t default_chunk_elements(size_t size) {
+        size_t chunk = 1;
+        while (chunk * 2 * size <= 65536) chunk *= 2;
+        return chunk;
+    }
+
+    /**
+     * @brief Sequence stored in fixed-size chunks that never move
+     * @tparam T Element type
+     * @tparam Chunk Elements per chunk, a power of two
+     * @tparam Alloc Allocator for the chunks and the directory
+     */
+    template<typename T, size_t Chunk = default_chunk_elements(sizeof(T)), typename Alloc = std::allocator<T>>
+    class SegmentedVector {
+        static_assert(Chunk > 0 && (Chunk & (Chunk - 1)) == 0, "Chunk size must be a power of two");
+
+    private:
+        using Traits = std::allocator_traits<Alloc>;
+        using DirectoryAlloc = typename Traits::template rebind_alloc<T*>;
+
+        static constexpr size_t shift = [] {
+            size_t bits = 0;
+            while ((size_t(1) << bits) < Chunk) ++bits;
+            return bits;
+        }();
+        static constexpr size_t mask = Chunk - 1;
+
+        /**
+         * @brief Random-access iterator over the elements
+         * @tparam Const Whether the iterator only reads
+         */
+        template<bool Const>
+        class Iterator {
+        public:
+            using iterator_category = std::random_access_iterator_tag;
+            using value_type = T;
+            using difference_type = std::ptrdiff_t;
+            using pointer = std::conditional_t<Const, const T*, T*>;
+            using reference = std::conditional_t<Const, const T&, T&>;
+
+        private:
+            using Owner = std::conditional_t<Const, const SegmentedVector, SegmentedVector>;
+            friend class SegmentedVector;
+
+            Owner* owner = nullptr; ///< Vector being iterated
+            size_t index = 0;       ///< Position of the current element
+
+        public:
+            Iterator() = default;
+            Iterator(Owner* o, size_t i) : owner(o), index(i) {}
+
+            /**
+             * @brief Converts a mutable iterator to a const one
+             */
+            template<bool Other, typename = std::enable_if_t<Const && !Other>>
+            Iterator(const Iterator<Other>& other) : owner(other.owner), index(other.index) {}
+
+            reference operator*() const { return (*owner)[index]; }
+            pointer operator->() const { return &(*owner)[index]; }
+            reference operator[](difference_type n) const { return (*owner)[index + n]; }
+
+            Iterator& operator++() { ++index; return *this; }
+            Iterator operator++(int) { Iterator temp = *this; ++index; return temp; }
+            Iterator& operator--() { --index; return *this; }
+            Iterator operator--(int) { Iterator temp = *this; --index; return temp; }
+            Iterator& operator+=(difference_type n) { index += n; return *this; }
+            Iterator& operator-=(difference_type n) { index -= n; return *this; }
+
+            friend Iterator operator+(Iterator it, difference_type n) { return it += n; }
+            friend Iterator operator+(difference_type n, Iterator it) { return it += n; }
+            friend Iterator operator-(Iterator it, difference_type n) { return it -= n; }
+            friend difference_type operator-(const Iterator& a, const Iterator& b) {
+                return static_cast<difference_type>(a.index) - static_cast<difference_type>(b.index);
+            }
+
+            friend bool operator==(const Iterator& a, const Iterator& b) { return a.index == b.index; }
+            friend bool operator!=(const Iterator& a, const Iterator& b) { return a.index != b.index; }
+            friend bool operator<(const Iterator& a, const Iterator& b) { return a.index < b.index; }
+            friend bool operator>(const Iterator& a, const Iterator& b) { return a.index > b.index; }
+            friend bool operator<=(const Iterator& a, const Iterator& b) { return a.index <= b.index; }
+            friend bool operator>=(const Iterator& a, const Iterator& b) { return a.index >= b.index; }
+
+            template<bool> friend class Iterator;
+        };
+
+    public:
+        using value_type = T;
+        using allocator_type = Alloc;
+        using size_type = size_t;
+        using difference_type = std::ptrdiff_t;
+        using reference = T&;
+        using const_reference = const T&;
+        using iterator = Iterator<false>;
+        using const_iterator = Iterator<true>;
+
+        static constexpr size_t chunk_size = Chunk; ///< Elements per chunk
+
+    private:
+        Alloc alloc;                              ///< Allocator for chunks and element construction
+        std::vector<T*, DirectoryAlloc> chunks;   ///< Directory of chunks, each holding Chunk elements
+        size_t count = 0;                         ///< Number of live elements
+
+        /**
+         * @brief Destroys every element and frees every chunk
+         * Time Complexity: O(n)
+         */
+        void release() noexcept {
+            clear();
+            for (T* chunk : chunks) Traits::deallocate(alloc, chunk, Chunk);
+            chunks.clear();
+        }
+
+        /**
+         * @brief Takes other's elements, stealing its chunks when allowed
+         * @param other Vector to take from, left empty
+         * Time Complexity: O(1) with a compatible allocator, O(n) otherwise
+         */
+        void take(SegmentedVector& other) {
+            if (alloc == other.alloc) {
+                chunks.swap(other.chunks);
+                std::swap(count, other.count);
+                return;
+            }
+            reserve(other.count);
+            for (T& value : other) emplace_back(std::move(value));
+            other.clear();
+        }
+
+    public:
+        SegmentedVector() = default;
+
+        /**
+         * @brief Creates an empty vector allocating from a
+         * @param a Allocator for chunks and the directory
+         */
+        explicit SegmentedVector(const Alloc& a) : alloc(a), chunks(DirectoryAlloc(a)) {}
+
+        template<typename InputIt, typename = std::enable_if_t<std::is_convertible<
+            typename std::iterator_traits<InputIt>::iterator_category, std::input_iterator_tag>::value>>
+        SegmentedVector(InputIt first, InputIt last, const Alloc& a = Alloc()) : SegmentedVector(a) {
+            insert(end(), first, last);
+        }
+
+        SegmentedVector(std::initializer_list<T> values, const Alloc& a = Alloc()) :
+            SegmentedVector(values.begin(), values.end(), a) {}
+
+        SegmentedVector(const SegmentedVector& other) :
+            SegmentedVector(other, Traits::select_on_container_copy_construction(other.alloc)) {}
+
+        SegmentedVector(const SegmentedVector& other, const Alloc& a) :
+            SegmentedVector(other.begin(), other.end(), a) {}
+
+        /**
+         * @brief Move constructor
+         * Time Complexity: O(1), the chunks change owner
+         */
+        SegmentedVector(SegmentedVector&& other) noexcept :
+            alloc(std::move(other.alloc)),
+            chunks(std::move(other.chunks)),
+            count(other.count) {
+            other.chunks.clear();
+            other.count = 0;
+        }
+
+        SegmentedVector& operator=(const SegmentedVector& other) {
+            if (this != &other) {
+                if (Traits::propagate_on_container_copy_assignment::value && alloc != other.alloc) {
+                    release();
+                    alloc = other.alloc;
+                    chunks = decltype(chunks)(DirectoryAlloc(alloc));
+                }
+                clear();
+                insert(end(), other.begin(), other.end());
+            }
+            return *this;
+        }
+
+        SegmentedVector& operator=(SegmentedVector&& other) noexcept(
+            Traits::propagate_on_container_move_assignment::value || Traits::is_always_equal::value) {
+            if (this != &other) {
+                release();
+                if (Traits::propagate_on_container_move_assignment::value) {
+                    alloc = std::move(other.alloc);
+                    chunks = decltype(chunks)(DirectoryAlloc(alloc));
+                }
+                take(other);
+            }
+            return *this;
+        }
+
+        ~SegmentedVector() {
+            release();
+        }
+
+        allocator_type get_allocator() const { return alloc; }
+
+        iterator begin() noexcept { return iterator(this, 0); }
+        iterator end() noexcept { return iterator(this, count); }
+        const_iterator begin() const noexcept { return const_iterator(this, 0); }
+        const_iterator end() const noexcept { return const_iterator(this, count); }
+
+        size_t size() const noexcept { return count; }
+        bool empty() const noexcept { return count == 0; }
+
+        /**
+         * @brief Number of elements that fit in the allocated chunks
+         * Time Complexity: O(1)
+         */
+        size_t capacity() const noexcept { return chunks.size() * Chunk; }
+
+        /**
+         * @brief Number of chunks allocated
+         * Time Complexity: O(1)
+         */
+        size_t chunk_count() const noexcept { return chunks.size(); }
+
+        /**
+         * @brief Bytes held by the chunk directory
+         * Time Complexity: O(1)
+         */
+        size_t directory_bytes() const noexcept { return chunks.capacity() * sizeof(T*); }
+
+        T& operator[](size_t i) { return chunks[i >> shift][i & mask]; }
+        const T& operator[](size_t i) const { return chunks[i >> shift][i & mask]; }
+        T& back() { return (*this)[count - 1]; }
+        const T& back() const { return (*this)[count - 1]; }
+
+        /**
+         * @brief Allocates chunks until n elements fit
+         * @param n Number of elements
+         * Time Complexity: O(n / Chunk); no element moves
+         */
+        void reserve(size_t n) {
+            size_t needed = (n + mask) >> shift;
+            if (needed <= chunks.size()) return;
+            chunks.reserve(needed);
+            while (chunks.size() < needed) {
+                chunks.push_back(Traits::allocate(alloc, Chunk));
+            }
+        }
+
+        /**
+         * @brief Constructs an element at the back
+         * @param args Arguments forwarded to T's constructor
+         * @return Reference to the new element
+         * Time Complexity: O(1) amortized, existing elements never move
+         */
+        template<typename... Args>
+        T& emplace_back(Args&&... args) {
+            if (count == capacity()) {
+                // Grow the directory first so that pushing the new chunk cannot throw and leak it
+                if (chunks.size() == chunks.capacity()) chunks.reserve(std::max<size_t>(8, chunks.size() * 2));
+                chunks.push_back(Traits::allocate(alloc, Chunk));
+            }
+            T* slot = &(*this)[count];
+            Traits::construct(alloc, slot, std::forward<Args>(args)...);
+            ++count;
+            return *slot;
+        }
+
+        void push_back(const T& value) { emplace_back(value); }
+        void push_back(T&& value) { emplace_back(std::move(value)); }
+
+        void pop_back() {
+            --count;
+            Traits::destroy(alloc, &(*this)[count]);
+        }
+
+        /**
+         * @brief Destroys every element, keeping the chunks
+         * Time Complexity: O(n)
+         */
+        void clear() noexcept {
+            while (count != 0) pop_back();
+        }
+
+        /**
+         * @brief Inserts the elements of [first, last) before pos
+         * @return Iterator to the first inserted element
+         * Time Complexity: O(m) at the back, O(n + m) elsewhere
+         */
+        template<typename InputIt>
+        iterator insert(const_iterator pos, InputIt first, InputIt last) {
+            size_t offset = pos.index;
+            size_t old_size = count;
+            if constexpr (std::is_convertible<typename std::iterator_traits<InputIt>::iterator_category,
+                                              std::forward_iterator_tag>::value) {
+                reserve(count + static_cast<size_t>(std::distance(first, last)));
+            }
+            for (; first != last; ++first) {
+                emplace_back(*first);
+            }
+            std::rotate(begin() + offset, begin() + old_size, end());
+            return begin() + offset;
+        }
+
+        /**
+         * @brief Erases the element at pos
+         * @return Iterator to the element that followed it
+         * Time Complexity: O(n)
+         */
+        iterator erase(const_iterator pos) {
+            return erase(pos, pos + 1);
+        }
+
+        /**
+         * @brief Erases the elements in [first, last)
+         * @return Iterator to the element that followed them
+         * Time Complexity: O(n)
+         */
+        iterator erase(const_iterator first, const_iterator last) {
+            iterator target = begin() + first.index;
+            iterator new_end = std::move(begin() + last.index, end(), target);
+            while (count != new_end.index) pop_back();
+            return target;
+        }
+    };
+
+    template<typename T, size_t Chunk, typename Alloc>
+    size_t heap_bytes(const SegmentedVector<T, Chunk, Alloc>& storage) {
+        return storage.capacity() * sizeof(T) + storage.directory_bytes();
+    }
+}
+}
@@ -0,0 +1,373 @@
+// author: avivoz4@gmail.com
+
+/**
+ * @file SmallVector.hpp
+ * @brief Vector with inline capacity, the element storage behind SmallContainer
+ * @author Aviv Oz
+ * @email avivoz4@gmail.com
+ *
+ * The first N elements live in a buffer inside the object, so a container
+ * that never grows past N never touches the heap. On overflow the elements
+ * move to allocator memory and the vector behaves like std::vector from then
+ * on. Only the subset of the std::vector interface that MyContainer uses is
+ * provided, and iterators are plain pointers.
+ */
+
+#pragma once
+#include <memory>
+#include <cstddef>
+#include <utility>
+#include <iterator>
+#include <algorithm>
+#include <type_traits>
+#include <initializer_list>
+
+namespace containers {
+namespace detail {
+
+    /**
+     * @brief Contiguous sequence storing up to N elements without allocating
+     * @tparam T Element type
+     * @tparam N Number of elements stored inline
+     * @tparam Alloc Allocator used once the elements no longer fit inline
+     */
+    template<typename T, size_t N, typename Alloc = std::allocator<T>>
+    class SmallVector {
+        static_assert(N > 0, "SmallVector needs an inline capacity of at least one element");
+
+    public:
+        using value_type = T;
+        using allocator_type = Alloc;
+        using size_type = size_t;
+        using difference_type = std::ptrdiff_t;
+        using reference = T&;
+        using const_reference = const T&;
+        using pointer = T*;
+        using const_pointer = const T*;
+        using iterator = T*;
+        using const_iterator = const T*;
+
+    private:
+        using Traits = std::allocator_traits<Alloc>;
+
+        Alloc alloc;                                       ///< Allocator for heap storage and element construction
+        T* first;                                          ///< Start of the elements, inline or on the heap
+        size_t count = 0;                                  ///< Number of live elements
+        size_t limit = N;                                  ///< Elements that fit before growing
+        alignas(T) unsigned char local[sizeof(T) * N];     ///< Inline buffer for the first N elements
+
+        T* local_data() {
+            return reinterpret_cast<T*>(local);
+        }
+
+        /**
+         * @brief Whether the elements are in the inline buffer
+         * Time Complexity: O(1)
+         */
+        bool is_local() const {
+            return first == reinterpret_cast<const T*>(local);
+        }
+
+        /**
+         * @brief Destroys every element and frees heap storage, back to the inline buffer
+         * Time Complexity: O(n)
+         */
+        void release() noexcept {
+            clear();
+            if (!is_local()) {
+                Traits::deallocate(alloc, first, limit);
+                first = local_data();
+                limit = N;
+            }
+        }
+
+        /**
+         * @brief Moves or copies the elements into fresh storage of the given capacity
+         * @param target Uninitialised storage for at least count elements
+         * Time Complexity: O(n)
+         *
+         * Elements are moved when that cannot throw, or when they cannot be
+         * copied, as std::vector does; on an exception target is left empty.
+         */
+        void relocate_into(T* target) {
+            size_t built = 0;
+            try {
+                for (; built < count; ++built) {
+                    Traits::construct(alloc, target + built, std::move_if_noexcept(first[built]));
+                }
+            } catch (...) {
+                for (size_t i = 0; i < built; ++i) Traits::destroy(alloc, target + i);
+                throw;
+            }
+        }
+
+        /**
+         * @brief Capacity to grow to when at least needed elements must fit
+         * Time Complexity: O(1)
+         */
+        size_t grown_capacity(size_t needed) const {
+            return std::max(needed, limit * 2);
+        }
+
+        /**
+         * @brief Moves the elements to heap storage of the given capacity
+         * @param capacity New capacity, greater than the current one
+         * Time Complexity: O(n)
+         */
+        void grow(size_t capacity) {
+            T* target = Traits::allocate(alloc, capacity);
+            try {
+                relocate_into(target);
+            } catch (...) {
+                Traits::deallocate(alloc, target, capacity);
+                throw;
+            }
+            adopt(target, capacity);
+        }
+
+        /**
+         * @brief Replaces the current storage with relocated elements
+         * @param target Storage already holding count relocated elements
+         * @param capacity Capacity of target
+         * Time Complexity: O(n) to destroy the old elements
+         */
+        void adopt(T* target, size_t capacity) noexcept {
+            for (size_t i = 0; i < count; ++i) Traits::destroy(alloc, first + i);
+            if (!is_local()) Traits::deallocate(alloc, first, limit);
+            first = target;
+            limit = capacity;
+        }
+
+        /**
+         * @brief Takes other's elements, stealing its heap storage when allowed
+         * @param other Vector to take from, left empty
+         * Time Complexity: O(1) for heap storage with a compatible allocator, O(n) otherwise
+         */
+        void take(SmallVector& other) {
+            if (!other.is_local() && alloc == other.alloc) {
+                first = other.first;
+                count = other.count;
+                limit = other.limit;
+                other.first = other.local_data();
+                other.count = 0;
+                other.limit = N;
+                return;
+            }
+            reserve(other.count);
+            for (T& value : other) emplace_back(std::move(value));
+            other.clear();
+        }
+
+    public:
+        SmallVector() noexcept(std::is_nothrow_default_constructible<Alloc>::value) : first(local_data()) {}
+
+        /**
+         * @brief Creates an empty vector that allocates from alloc on overflow
+         * @param a Allocator for heap storage
+         */
+        explicit SmallVector(const Alloc& a) noexcept : alloc(a), first(local_data()) {}
+
+        template<typename InputIt, typename = std::enable_if_t<std::is_convertible<
+            typename std::iterator_traits<InputIt>::iterator_category, std::input_iterator_tag>::value>>
+        SmallVector(InputIt begin, InputIt end, const Alloc& a = Alloc()) : SmallVector(a) {
+            insert(this->end(), begin, end);
+        }
+
+        SmallVector(std::initializer_list<T> values, const Alloc& a = Alloc()) :
+            SmallVector(values.begin(), values.end(), a) {}
+
+        SmallVector(const SmallVector& other) :
+            SmallVector(other, Traits::select_on_container_copy_construction(other.alloc)) {}
+
+        SmallVector(const SmallVector& other, const Alloc& a) : SmallVector(other.begin(), other.end(), a) {}
+
+        /**
+         * @brief Move constructor
+         * Time Complexity: O(1) for heap storage, O(n) element moves for inline storage
+         */
+        SmallVector(SmallVector&& other) noexcept(std::is_nothrow_move_constructible<T>::value) :
+            alloc(std::move(other.alloc)), first(local_data()) {
+            take(other);
+        }
+
+        SmallVector& operator=(const SmallVector& other) {
+            if (this != &other) {
+                if (Traits::propagate_on_container_copy_assignment::value && alloc != other.alloc) {
+                    release();
+                }
+                if (Traits::propagate_on_container_copy_assignment::value) {
+                    alloc = other.alloc;
+                }
+                clear();
+                insert(end(), other.begin(), other.end());
+            }
+            return *this;
+        }
+
+        SmallVector& operator=(SmallVector&& other) noexcept(
+            std::is_nothrow_move_constructible<T>::value &&
+            (Traits::propagate_on_container_move_assignment::value || Traits::is_always_equal::value)) {
+            if (this != &other) {
+                release();
+                if (Traits::propagate_on_container_move_assignment::value) {
+                    alloc = std::move(other.alloc);
+                }
+                take(other);
+            }
+            return *this;
+        }
+
+        ~SmallVector() {
+            release();
+        }
+
+        allocator_type get_allocator() const { return alloc; }
+
+        iterator begin() noexcept { return first; }
+        iterator end() noexcept { return first + count; }
+        const_iterator begin() const noexcept { return first; }
+        const_iterator end() const noexcept { return first + count; }
+
+        size_t size() const noexcept { return count; }
+        bool empty() const noexcept { return count == 0; }
+
+        /**
+         * @brief Number of elements that fit without reallocating
+         * Time Complexity: O(1)
+         */
+        size_t capacity() const noexcept { return limit; }
+
+        /**
+         * @brief Whether the elements live in the inline buffer
+         * Time Complexity: O(1)
+         */
+        bool is_inline() const noexcept { return is_local(); }
+
+        T& operator[](size_t i) { return first[i]; }
+        const T& operator[](size_t i) const { return first[i]; }
+        T& back() { return first[count - 1]; }
+        const T& back() const { return first[count - 1]; }
+
+        /**
+         * @brief Ensures room for n elements, moving to the heap if n exceeds N
+         * @param n Number of elements
+         * Time Complexity: O(n) if storage has to grow, O(1) otherwise
+         */
+        void reserve(size_t n) {
+            if (n > limit) grow(n);
+        }
+
+        /**
+         * @brief Constructs an element at the back
+         * @param args Arguments forwarded to T's constructor
+         * @return Reference to the new element
+         * Time Complexity: O(1) amortized
+         *
+         * When storage has to grow, the new element is built before the old
+         * ones are relocated, so args may refer to an element of this vector.
+         */
+        template<typename... Args>
+        T& emplace_back(Args&&... args) {
+            if (count < limit) {
+                Traits::construct(alloc, first + count, std::forward<Args>(args)...);
+            } else {
+                size_t capacity = grown_capacity(count + 1);
+                T* target = Traits::allocate(alloc, capacity);
+                try {
+                    Traits::construct(alloc, target + count, std::forward<Args>(args)...);
+                } catch (...) {
+                    Traits::deallocate(alloc, target, capacity);
+                    throw;
+                }
+                try {
+                    relocate_into(target);
+                } catch (...) {
+                    Traits::destroy(alloc, target + count);
+                    Traits::deallocate(alloc, target, capacity);
+                    throw;
+                }
+                adopt(target, capacity);
+            }
+            return first[count++];
+        }
+
+        void push_back(const T& value) { emplace_back(value); }
+        void push_back(T&& value) { emplace_back(std::move(value)); }
+
+        void pop_back() {
+            Traits::destroy(alloc, first + --count);
+        }
+
+        /**
+         * @brief Destroys every element, keeping the storage
+         * Time Complexity: O(n)
+         */
+        void clear() noexcept {
+            for (size_t i = 0; i < count; ++i) Traits::destroy(alloc, first + i);
+            count = 0;
+        }
+
+        /**
+         * @brief Inserts the elements of [begin, end) before pos
+         * @return Iterator to the first inserted element
+         * Time Complexity: O(m) at the back, O(n + m) elsewhere
+         */
+        template<typename InputIt>
+        iterator insert(const_iterator pos, InputIt begin, InputIt end) {
+            size_t offset = static_cast<size_t>(pos - first);
+            size_t old_size = count;
+            if constexpr (std::is_convertible<typename std::iterator_traits<InputIt>::iterator_category,
+                                              std::forward_iterator_tag>::value) {
+                size_t added = static_cast<size_t>(std::distance(begin, end));
+                if (count + added > limit) grow(grown_capacity(count + added));
+            }
+            for (; begin != end; ++begin) {
+                emplace_back(*begin);
+            }
+            std::rotate(first + offset, first + old_size, first + count);
+            return first + offset;
+        }
+
+        /**
+         * @brief Erases the element at pos
+         * @return Iterator to the element that followed it
+         * Time Complexity: O(n)
+         */
+        iterator erase(const_iterator pos) {
+            return erase(pos, pos + 1);
+        }
+
+        /**
+         * @brief Erases the elements in [begin, end)
+         * @return Iterator to the element that followed them
+         * Time Complexity: O(n)
+         */
+        iterator erase(const_iterator begin, const_iterator end) {
+            T* target = first + (begin - first);
+            T* source = first + (end - first);
+            T* new_end = std::move(source, this->end(), target);
+            while (this->end() != new_end) pop_back();
+            return target;
+        }
+    };
+
+    /**
+     * @brief Number of elements a storage type keeps inside the container object
+     */
+    template<typename Storage>
+    struct inline_capacity : std::integral_constant<size_t, 0> {};
+
+    template<typename T, size_t N, typename Alloc>
+    struct inline_capacity<SmallVector<T, N, Alloc>> : std::integral_constant<size_t, N> {};
+
+    /**
+     * @brief Heap memory held by a storage's elements
+     * @return Bytes of allocated capacity; inline buffers count as part of the object
+     * Time Complexity: O(1)
+     */
+    template<typename T, size_t N, typename Alloc>
+    size_t heap_bytes(const SmallVector<T, N, Alloc>& storage) {
+        return storage.is_inline() ? 0 : storage.capacity() * sizeof(T);
+    }
+}
+}
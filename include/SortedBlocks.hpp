@@ -0,0 +1,253 @@
+// author: avivoz4@gmail.com
+
+/**
+ * @file SortedBlocks.hpp
+ * @brief Order-statistics structure over element positions for SortMode::Maintained
+ * @author Aviv Oz
+ * @email avivoz4@gmail.com
+ *
+ * Positions are kept in sorted order split across small blocks, like the
+ * leaf level of a B-tree, with a Fenwick tree over the block sizes. Inserting
+ * or erasing a position touches one block and O(log(n / B)) Fenwick counts,
+ * and the entry with a given rank is found by descending the Fenwick tree.
+ * Only splitting a full block or dropping an empty one renumbers the blocks
+ * and rebuilds the counts, which amortizes to O(n / B^2) per update.
+ */
+
+#pragma once
+#include <vector>
+#include <cstddef>
+#include <algorithm>
+#include <memory>
+
+namespace containers {
+namespace detail {
+
+    /**
+     * @brief Sorted sequence of element positions supporting access by rank
+     * @tparam Alloc Allocator the blocks and the directory are obtained from
+     *
+     * The ordering is supplied by the caller on every insert or erase as a
+     * strict total order over positions, so the structure itself never looks
+     * at element values.
+     */
+    template<typename Alloc = std::allocator<size_t>>
+    class SortedBlocks {
+    private:
+        template<typename U>
+        using rebind = typename std::allocator_traits<Alloc>::template rebind_alloc<U>;
+        using Block = std::vector<size_t, rebind<size_t>>;
+
+        static constexpr size_t block_size = 256; ///< Target entries per block, split at twice this
+
+        std::vector<Block, rebind<Block>> blocks;     ///< Sorted positions, block by block
+        std::vector<size_t, rebind<size_t>> counts;  ///< Fenwick tree over the block sizes
+        size_t total = 0;                            ///< Number of entries in all blocks
+
+        /**
+         * @brief Rebuilds the Fenwick tree after blocks were added, removed or renumbered
+         * Time Complexity: O(n / B)
+         */
+        void rebuild_counts() {
+            const size_t m = blocks.size();
+            counts.resize(m);
+            for (size_t i = 0; i < m; ++i) {
+                counts[i] = blocks[i].size();
+            }
+            for (size_t i = 1; i <= m; ++i) {
+                size_t parent = i + (i & (~i + 1));
+                if (parent <= m) counts[parent - 1] += counts[i - 1];
+            }
+        }
+
+        /**
+         * @brief Adds delta, modulo 2^64, to the size recorded for block b
+         * Time Complexity: O(log(n / B))
+         */
+        void adjust_count(size_t b, size_t delta) {
+            for (size_t i = b + 1; i <= counts.size(); i += i & (~i + 1)) {
+                counts[i - 1] += delta;
+            }
+        }
+
+        /**
+         * @brief Locates the block that holds, or would hold, a position
+         * @param position Position to locate
+         * @param less Strict total order over positions
+         * @return Index of the first block whose last entry is not less than position,
+         * or the last block if every entry is less
+         * Time Complexity: O(log(n / B)) comparisons
+         */
+        template<typename Less>
+        size_t block_for(size_t position, Less less) const {
+            auto it = std::lower_bound(blocks.begin(), blocks.end(), position,
+                [&less](const Block& block, size_t p) { return less(block.back(), p); });
+            if (it == blocks.end()) --it;
+            return static_cast<size_t>(it - blocks.begin());
+        }
+
+        /**
+         * @brief Creates a block holding a range of positions
+         * @return Block drawing memory from the structure's allocator
+         *
+         * Blocks are built first and then moved into place, so allocators that
+         * propagate themselves to nested containers, like std::pmr ones, and
+         * plain stateful allocators both end up using the same memory.
+         */
+        template<typename It>
+        Block make_block(It first, It last) const {
+            return Block(first, last, rebind<size_t>(blocks.get_allocator()));
+        }
+
+    public:
+        SortedBlocks() = default;
+
+        /**
+         * @brief Creates an empty structure drawing memory from alloc
+         * @param alloc Allocator for the blocks and the directory
+         */
+        explicit SortedBlocks(const Alloc& alloc) :
+            blocks(rebind<Block>(alloc)),
+            counts(rebind<size_t>(alloc)) {}
+
+        /**
+         * @brief Returns the number of positions held
+         * Time Complexity: O(1)
+         */
+        size_t size() const {
+            return total;
+        }
+
+        /**
+         * @brief Removes every entry and releases the blocks
+         * Time Complexity: O(n / B)
+         */
+        void clear() {
+            decltype(blocks)(blocks.get_allocator()).swap(blocks);
+            decltype(counts)(counts.get_allocator()).swap(counts);
+            total = 0;
+        }
+
+        /**
+         * @brief Replaces the contents with an already sorted sequence of positions
+         * @param first Iterator to the first position
+         * @param last Iterator past the last position
+         * Time Complexity: O(n)
+         */
+        template<typename It>
+        void assign(It first, It last) {
+            clear();
+            while (first != last) {
+                size_t take = std::min<size_t>(block_size, static_cast<size_t>(last - first));
+                blocks.push_back(make_block(first, first + take));
+                first += take;
+                total += take;
+            }
+            rebuild_counts();
+        }
+
+        /**
+         * @brief Inserts a position at its place in the order
+         * @param position Position to insert
+         * @param less Strict total order over positions
+         * Time Complexity: O(log n + B), plus O(n / B) for the block split that
+         * follows every B inserts into one block, O(log n + B + n / B^2) amortized
+         */
+        template<typename Less>
+        void insert(size_t position, Less less) {
+            ++total;
+            if (blocks.empty()) {
+                blocks.push_back(make_block(&position, &position + 1));
+                rebuild_counts();
+                return;
+            }
+            size_t b = block_for(position, less);
+            Block& block = blocks[b];
+            block.insert(std::lower_bound(block.begin(), block.end(), position, less), position);
+            if (block.size() > 2 * block_size) {
+                Block upper = make_block(block.begin() + block_size, block.end());
+                block.resize(block_size);
+                blocks.insert(blocks.begin() + b + 1, std::move(upper));
+                rebuild_counts();
+            } else {
+                adjust_count(b, 1);
+            }
+        }
+
+        /**
+         * @brief Erases a position
+         * @param position Position to erase; less must still order it as when inserted
+         * @param less Strict total order over positions
+         * Time Complexity: O(log n + B), plus O(n / B) when the block empties
+         */
+        template<typename Less>
+        void erase(size_t position, Less less) {
+            if (blocks.empty()) return;
+            size_t b = block_for(position, less);
+            Block& block = blocks[b];
+            auto it = std::lower_bound(block.begin(), block.end(), position, less);
+            if (it == block.end() || *it != position) return;
+            block.erase(it);
+            --total;
+            if (block.empty()) {
+                blocks.erase(blocks.begin() + b);
+                rebuild_counts();
+            } else {
+                adjust_count(b, static_cast<size_t>(-1));
+            }
+        }
+
+        /**
+         * @brief Renumbers positions after the element at position was erased
+         * @param position Position that was erased from the underlying storage
+         * Time Complexity: O(n)
+         *
+         * Every later position moves down by one. Relative order is unchanged,
+         * so no entry has to move.
+         */
+        void shift_down_after(size_t position) {
+            for (Block& block : blocks) {
+                for (size_t& p : block) {
+                    if (p > position) --p;
+                }
+            }
+        }
+
+        /**
+         * @brief Returns the position with the given rank
+         * @param rank Rank in the order, must be less than size()
+         * @return The position at that rank
+         * Time Complexity: O(log(n / B))
+         *
+         * Reads nothing but the blocks and the counts, so concurrent calls
+         * on an unmodified structure are safe.
+         */
+        size_t at(size_t rank) const {
+            const size_t m = counts.size();
+            size_t step = 1;
+            while (step * 2 <= m) step *= 2;
+            size_t b = 0;
+            for (; step != 0; step /= 2) {
+                if (b + step <= m && counts[b + step - 1] <= rank) {
+                    b += step;
+                    rank -= counts[b - 1];
+                }
+            }
+            return blocks[b][rank];
+        }
+
+        /**
+         * @brief Approximate heap memory held by the structure
+         * @return Bytes used by blocks and the Fenwick counts
+         * Time Complexity: O(n / B)
+         */
+        size_t memory_usage() const {
+            size_t bytes = blocks.capacity() * sizeof(Block) + counts.capacity() * sizeof(size_t);
+            for (const Block& block : blocks) {
+                bytes += block.capacity() * sizeof(size_t);
+            }
+            return bytes;
+        }
+    };
+}
+}
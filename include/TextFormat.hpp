@@ -0,0 +1,330 @@
+// author: avivoz4@gmail.com
+
+/**
+ * @file TextFormat.hpp
+ * @brief Buffered text formatting and parsing behind operator<<, write_to, parse and read_from
+ * @author Aviv Oz
+ * @email avivoz4@gmail.com
+ *
+ * Elements are formatted into a 64 KiB local buffer that is handed to a sink
+ * whenever it fills, so the destination sees a few large writes instead of
+ * two small ones per element. Arithmetic elements are formatted with
+ * std::to_chars, which neither allocates nor consults a locale; floating
+ * point values use the general format at a given precision, the same text
+ * a default-formatted std::ostream produces. Strings are copied as they
+ * are, and any other type goes through its own operator<<.
+ *
+ * Parsing accepts the same text back: numbers separated by commas and/or
+ * whitespace, optionally enclosed in brackets, read with std::from_chars.
+ * The parser takes its input in blocks, so streams are parsed as they are
+ * read rather than after being loaded whole.
+ */
+
+#pragma once
+#include <array>
+#include <string>
+#include <string_view>
+#include <cstddef>
+#include <cstring>
+#include <sstream>
+#include <optional>
+#include <stdexcept>
+#include <charconv>
+#include <type_traits>
+#include <system_error>
+
+namespace containers {
+namespace detail {
+
+    /**
+     * @brief Whether T is printed as a number by std::to_chars
+     *
+     * Character types and bool print as characters and words through
+     * std::ostream, so they are left to operator<<.
+     */
+    template<typename T>
+    struct is_chars_formattable : std::integral_constant<bool,
+        std::is_arithmetic<T>::value &&
+        !std::is_same<T, bool>::value &&
+        !std::is_same<T, char>::value &&
+        !std::is_same<T, signed char>::value &&
+        !std::is_same<T, unsigned char>::value &&
+        !std::is_same<T, wchar_t>::value &&
+        !std::is_same<T, char16_t>::value &&
+        !std::is_same<T, char32_t>::value> {};
+
+    /**
+     * @brief Whether T is formatted without going through operator<<
+     */
+    template<typename T>
+    struct is_fast_formattable : std::integral_constant<bool,
+        is_chars_formattable<T>::value || std::is_same<T, std::string>::value> {};
+
+    /**
+     * @brief Accumulates formatted text and passes it to a sink in large chunks
+     * @tparam Sink Callable taking (const char* data, size_t size)
+     */
+    template<typename Sink>
+    class TextWriter {
+    private:
+        static constexpr size_t capacity = 64 * 1024;
+
+        std::array<char, capacity> buffer;         ///< Pending text
+        size_t used = 0;                           ///< Bytes of buffer in use
+        Sink& sink;                                ///< Destination of full chunks
+        int precision;                             ///< Significant digits for floating point values
+        std::optional<std::ostringstream> scratch; ///< Formats types without a fast path, built on first use
+
+    public:
+        /**
+         * @brief Creates a writer in front of a sink
+         * @param s Destination of the formatted text
+         * @param digits Significant digits for floating point values, as std::ostream::precision
+         */
+        TextWriter(Sink& s, int digits) : sink(s), precision(digits) {}
+
+        /**
+         * @brief Appends one character
+         * Time Complexity: O(1) amortized
+         */
+        void put(char c) {
+            if (used == capacity) flush();
+            buffer[used++] = c;
+        }
+
+        /**
+         * @brief Appends a run of characters, bypassing the buffer for long runs
+         * Time Complexity: O(size)
+         */
+        void put(const char* data, size_t size) {
+            if (size > capacity - used) {
+                flush();
+                if (size >= capacity) {
+                    sink(data, size);
+                    return;
+                }
+            }
+            std::memcpy(buffer.data() + used, data, size);
+            used += size;
+        }
+
+        /**
+         * @brief Appends the text of one element
+         * @param value Element to format
+         * Time Complexity: O(length of the text)
+         */
+        template<typename T>
+        void put_value(const T& value) {
+            if constexpr (is_chars_formattable<T>::value) {
+                for (int attempt = 0; attempt < 2; ++attempt) {
+                    std::to_chars_result result;
+                    if constexpr (std::is_floating_point<T>::value) {
+                        result = std::to_chars(buffer.data() + used, buffer.data() + capacity, value,
+                                               std::chars_format::general, precision);
+                    } else {
+                        result = std::to_chars(buffer.data() + used, buffer.data() + capacity, value);
+                    }
+                    if (result.ec == std::errc()) {
+                        used = static_cast<size_t>(result.ptr - buffer.data());
+                        return;
+                    }
+                    flush();
+                }
+                throw std::length_error("Formatted element exceeds the output buffer");
+            } else if constexpr (std::is_same<T, std::string>::value) {
+                put(value.data(), value.size());
+            } else {
+                if (!scratch) {
+                    scratch.emplace();
+                    scratch->precision(precision);
+                } else {
+                    scratch->str(std::string());
+                }
+                *scratch << value;
+                std::string text = scratch->str();
+                put(text.data(), text.size());
+            }
+        }
+
+        /**
+         * @brief Hands any pending text to the sink
+         * Time Complexity: O(pending bytes)
+         */
+        void flush() {
+            if (used != 0) {
+                sink(buffer.data(), used);
+                used = 0;
+            }
+        }
+    };
+    /**
+     * @brief Whether c separates elements in parsed text
+     */
+    inline bool is_text_space(char c) {
+        return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\f' || c == '\v';
+    }
+
+    /**
+     * @brief Counts the elements in text without parsing them
+     * @param text Input in the format accepted by parse_text
+     * @return Number of maximal runs of characters other than whitespace, commas and brackets
+     * Time Complexity: O(length)
+     *
+     * Exact for valid input; used to size element storage before parsing.
+     */
+    inline size_t count_tokens(std::string_view text) {
+        size_t count = 0;
+        bool in_token = false;
+        for (char c : text) {
+            bool separator = is_text_space(c) || c == ',' || c == '[' || c == ']';
+            if (!separator && !in_token) ++count;
+            in_token = !separator;
+        }
+        return count;
+    }
+
+    /**
+     * @brief Incremental parser for numbers separated by commas and/or whitespace,
+     * optionally within brackets
+     * @tparam T Arithmetic element type
+     *
+     * Input arrives in blocks of any size through feed(), and finish() checks
+     * the end of the input. A number cut off at a block boundary is carried
+     * over to the next block, so only the current block and that one token
+     * are ever held. Errors name their offset in the whole input.
+     */
+    template<typename T>
+    class TextParser {
+    private:
+        enum class State {
+            Start,  ///< Nothing but whitespace seen so far
+            Values, ///< Before an element, at the start or after a comma
+            Token,  ///< Inside an element
+            After,  ///< After an element
+            Closed  ///< After the closing bracket
+        };
+
+        State state = State::Start;
+        bool bracketed = false;  ///< Whether the input opened with '['
+        bool need_value = false; ///< Whether a comma still waits for its element
+        size_t offset = 0;       ///< Offset of the next block in the whole input
+        size_t token_offset = 0; ///< Offset of the element being read
+        std::string carry;       ///< Start of an element cut off by the previous block
+
+        [[noreturn]] static void fail(const char* what, size_t at) {
+            throw std::runtime_error(std::string(what) + " at offset " + std::to_string(at));
+        }
+
+        bool ends_token(char c) const {
+            return is_text_space(c) || c == ',' || (bracketed && c == ']');
+        }
+
+        /**
+         * @brief Converts one complete element and passes it on
+         * Time Complexity: O(length of the element)
+         */
+        template<typename Emit>
+        void convert(const char* first, const char* last, Emit& emit) {
+            T value;
+            std::from_chars_result result;
+            if constexpr (std::is_floating_point<T>::value) {
+                result = std::from_chars(first, last, value, std::chars_format::general);
+            } else {
+                result = std::from_chars(first, last, value);
+            }
+            if (result.ec == std::errc::result_out_of_range) fail("Element out of range", token_offset);
+            if (result.ec != std::errc() || result.ptr != last) fail("Invalid element", token_offset);
+            emit(value);
+            state = State::After;
+        }
+
+    public:
+        /**
+         * @brief Parses the next block of input
+         * @param block Text following the previous block
+         * @param emit Callable taking each parsed T in order
+         * @throws std::runtime_error naming the offset of the first malformed or out-of-range element
+         * Time Complexity: O(length of block)
+         */
+        template<typename Emit>
+        void feed(std::string_view block, Emit emit) {
+            const char* const first = block.data();
+            const char* const last = first + block.size();
+            const char* token = first;
+            for (const char* p = first; p != last; ++p) {
+                const char c = *p;
+                const size_t at = offset + static_cast<size_t>(p - first);
+                if (state == State::Token) {
+                    if (!ends_token(c)) continue;
+                    if (carry.empty()) {
+                        convert(token, p, emit);
+                    } else {
+                        carry.append(token, p);
+                        convert(carry.data(), carry.data() + carry.size(), emit);
+                        carry.clear();
+                    }
+                } else if (state == State::Start) {
+                    if (is_text_space(c)) continue;
+                    state = State::Values;
+                    if (c == '[') {
+                        bracketed = true;
+                        continue;
+                    }
+                } else if (state == State::Closed) {
+                    if (!is_text_space(c)) fail("Unexpected character", at);
+                    continue;
+                }
+
+                // Values or After
+                if (is_text_space(c)) continue;
+                if (c == ',') {
+                    if (state != State::After) fail("Invalid element", at);
+                    state = State::Values;
+                    need_value = true;
+                } else if (bracketed && c == ']') {
+                    if (need_value) fail("Missing element", at);
+                    state = State::Closed;
+                } else {
+                    state = State::Token;
+                    token = p;
+                    token_offset = at;
+                    need_value = false;
+                }
+            }
+            if (state == State::Token) carry.append(token, last);
+            offset += block.size();
+        }
+
+        /**
+         * @brief Parses an element left open by the last block and checks the input is complete
+         * @param emit Callable taking the last parsed T, if any
+         * @throws std::runtime_error if an element or the closing bracket is missing
+         * Time Complexity: O(length of a carried element)
+         */
+        template<typename Emit>
+        void finish(Emit emit) {
+            if (state == State::Token) {
+                convert(carry.data(), carry.data() + carry.size(), emit);
+                carry.clear();
+            }
+            if (need_value) fail("Missing element", offset);
+            if (bracketed && state != State::Closed) fail("Missing ']'", offset);
+        }
+    };
+
+    /**
+     * @brief Parses numbers separated by commas and/or whitespace, optionally within brackets
+     * @tparam T Arithmetic element type
+     * @param text Input such as "[1,2,3]", "1 2 3" or one number per line
+     * @param emit Callable taking each parsed T in order
+     * @throws std::runtime_error naming the offset of the first malformed or out-of-range element
+     * Time Complexity: O(length)
+     */
+    template<typename T, typename Emit>
+    void parse_text(std::string_view text, Emit emit) {
+        TextParser<T> parser;
+        parser.feed(text, emit);
+        parser.finish(emit);
+    }
+}
+}
@@ -0,0 +1,321 @@
+// author: avivoz4@gmail.com
+
+/**
+ * @file ValueIndex.hpp
+ * @brief Optional hash index from element values to their positions in MyContainer
+ * @author Aviv Oz
+ * @email avivoz4@gmail.com
+ *
+ * Positions shift whenever an element is erased from the middle of the
+ * container, so the index does not store positions directly. Every element
+ * gets an insertion stamp instead; stamps only ever grow, so the stamps of
+ * the live elements, kept in a vector parallel to the elements, are sorted
+ * and a position is recovered from a stamp by binary search.
+ *
+ * Lookups are const and never rebuild. A container checks stale() and calls
+ * refresh() first, under the lock it already holds for its other lazy caches.
+ */
+
+#pragma once
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <atomic>
+#include <algorithm>
+#include <functional>
+#include <unordered_map>
+
+namespace containers {
+namespace detail {
+
+    /**
+     * @brief Type-erased multimap from values to insertion stamps
+     * @tparam T Element type
+     *
+     * Only the concrete HashValueMap names std::hash<T>, so containers of
+     * types without a hash compile as long as the index is never enabled.
+     */
+    template<typename T>
+    class ValueMap {
+    public:
+        virtual ~ValueMap() = default;
+        virtual std::unique_ptr<ValueMap> clone() const = 0;
+        virtual void insert(const T& value, uint64_t stamp) = 0;
+        virtual void erase(const T& value, uint64_t stamp) = 0;
+        virtual void restamp(const T& value, uint64_t old_stamp, uint64_t new_stamp) = 0;
+        virtual bool first_stamp(const T& value, uint64_t& stamp) const = 0;
+        virtual size_t count(const T& value) const = 0;
+        virtual void clear() = 0;
+        virtual size_t memory_usage() const = 0;
+    };
+
+    /**
+     * @brief ValueMap backed by std::unordered_multimap
+     * @tparam T Element type
+     * @tparam Hash Hash function for T
+     */
+    template<typename T, typename Hash>
+    class HashValueMap : public ValueMap<T> {
+    private:
+        std::unordered_multimap<T, uint64_t, Hash> entries; ///< Value to stamp, one entry per element
+
+    public:
+        std::unique_ptr<ValueMap<T>> clone() const override {
+            return std::make_unique<HashValueMap>(*this);
+        }
+
+        void insert(const T& value, uint64_t stamp) override {
+            entries.emplace(value, stamp);
+        }
+
+        void erase(const T& value, uint64_t stamp) override {
+            auto range = entries.equal_range(value);
+            for (auto it = range.first; it != range.second; ++it) {
+                if (it->second == stamp) {
+                    entries.erase(it);
+                    return;
+                }
+            }
+        }
+
+        void restamp(const T& value, uint64_t old_stamp, uint64_t new_stamp) override {
+            auto range = entries.equal_range(value);
+            for (auto it = range.first; it != range.second; ++it) {
+                if (it->second == old_stamp) {
+                    it->second = new_stamp;
+                    return;
+                }
+            }
+        }
+
+        bool first_stamp(const T& value, uint64_t& stamp) const override {
+            auto range = entries.equal_range(value);
+            if (range.first == range.second) return false;
+            stamp = range.first->second;
+            for (auto it = std::next(range.first); it != range.second; ++it) {
+                stamp = std::min(stamp, it->second);
+            }
+            return true;
+        }
+
+        size_t count(const T& value) const override {
+            return entries.count(value);
+        }
+
+        void clear() override {
+            entries.clear();
+        }
+
+        size_t memory_usage() const override {
+            // One heap node per entry (next pointer, stored pair, cached hash)
+            // plus the bucket array
+            const size_t node = sizeof(void*) + sizeof(std::pair<const T, uint64_t>) + sizeof(size_t);
+            return sizeof(*this) + entries.size() * node + entries.bucket_count() * sizeof(void*);
+        }
+    };
+
+    /**
+     * @brief Optional value index kept in step with a container's elements
+     * @tparam T Element type
+     *
+     * Disabled by default, in which case every hook returns immediately.
+     * Copying the index deep-copies the underlying map.
+     */
+    template<typename T>
+    class ValueIndex {
+    private:
+        std::unique_ptr<ValueMap<T>> map; ///< Value to stamp map, null while disabled
+        std::vector<uint64_t> stamps;     ///< Stamp of each element, parallel to the elements
+        uint64_t next_stamp = 0;          ///< Stamp handed to the next added element
+        std::atomic<bool> dirty{false};   ///< Set when elements may have changed behind the index
+
+        bool is_dirty() const {
+            return dirty.load(std::memory_order_relaxed);
+        }
+
+    public:
+        static constexpr size_t npos = static_cast<size_t>(-1); ///< Returned when a value is absent
+
+        ValueIndex() = default;
+
+        ValueIndex(ValueIndex&& other) noexcept :
+            map(std::move(other.map)),
+            stamps(std::move(other.stamps)),
+            next_stamp(other.next_stamp),
+            dirty(other.is_dirty()) {}
+
+        ValueIndex& operator=(ValueIndex&& other) noexcept {
+            map = std::move(other.map);
+            stamps = std::move(other.stamps);
+            next_stamp = other.next_stamp;
+            dirty.store(other.is_dirty(), std::memory_order_relaxed);
+            return *this;
+        }
+
+        ValueIndex(const ValueIndex& other) :
+            map(other.map ? other.map->clone() : nullptr),
+            stamps(other.stamps),
+            next_stamp(other.next_stamp),
+            dirty(other.is_dirty()) {}
+
+        ValueIndex& operator=(const ValueIndex& other) {
+            if (this != &other) {
+                ValueIndex copy(other);
+                *this = std::move(copy);
+            }
+            return *this;
+        }
+
+        /**
+         * @brief Whether the index is maintained
+         * Time Complexity: O(1)
+         */
+        bool enabled() const {
+            return map != nullptr;
+        }
+
+        /**
+         * @brief Starts maintaining the index over the given elements
+         * @tparam Hash Hash function for T
+         * @param elements The container's current elements
+         * Time Complexity: O(n) expected
+         */
+        template<typename Hash, typename Elements>
+        void enable(const Elements& elements) {
+            map = std::make_unique<HashValueMap<T, Hash>>();
+            rebuild(elements);
+        }
+
+        /**
+         * @brief Stops maintaining the index and frees its memory
+         * Time Complexity: O(n)
+         */
+        void disable() {
+            map.reset();
+            std::vector<uint64_t>().swap(stamps);
+            dirty.store(false, std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Marks the index stale, e.g. after elements were handed out by reference
+         * Time Complexity: O(1); the next query rebuilds in O(n)
+         */
+        void invalidate() {
+            if (map) dirty.store(true, std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Records an element appended at the back of the container
+         * @param value The new last element
+         * Time Complexity: O(1) expected
+         */
+        void pushed(const T& value) {
+            if (!map || is_dirty()) return;
+            stamps.push_back(next_stamp);
+            map->insert(value, next_stamp++);
+        }
+
+        /**
+         * @brief Forgets the element at a position that is about to be erased
+         * @param position Position of the element
+         * @param value The element at that position
+         * Time Complexity: O(n) for the stamp shift, O(1) expected for the map
+         */
+        void erasing(size_t position, const T& value) {
+            if (!map || is_dirty()) return;
+            map->erase(value, stamps[position]);
+            stamps.erase(stamps.begin() + position);
+        }
+
+        /**
+         * @brief Records that the last element replaces the one at a position
+         * @param position Position of the removed element
+         * @param removed The element being removed
+         * @param last The last element, which moves into position
+         * Time Complexity: O(1) expected
+         *
+         * The moved element inherits the removed element's stamp, which keeps
+         * the stamps sorted by position.
+         */
+        void replacing_with_last(size_t position, const T& removed, const T& last) {
+            if (!map || is_dirty()) return;
+            map->erase(removed, stamps[position]);
+            if (position + 1 != stamps.size()) {
+                map->restamp(last, stamps.back(), stamps[position]);
+            }
+            stamps.pop_back();
+        }
+
+        /**
+         * @brief Whether the next lookup must be preceded by refresh()
+         * Time Complexity: O(1)
+         *
+         * A false result also makes the entries written by the last refresh()
+         * visible to the calling thread.
+         */
+        bool stale() const {
+            return dirty.load(std::memory_order_acquire);
+        }
+
+        /**
+         * @brief Rebuilds the index if elements changed behind it
+         * @param elements The container's current elements
+         * Time Complexity: O(n) expected after invalidate(), O(1) otherwise
+         */
+        template<typename Elements>
+        void refresh(const Elements& elements) {
+            if (is_dirty()) rebuild(elements);
+        }
+
+        /**
+         * @brief Finds the position of the first element equal to value
+         * @param value Value to look for
+         * @return Position of the first occurrence, or npos if absent
+         * Time Complexity: O(log n) expected
+         */
+        size_t find(const T& value) const {
+            uint64_t stamp;
+            if (!map->first_stamp(value, stamp)) return npos;
+            return static_cast<size_t>(std::lower_bound(stamps.begin(), stamps.end(), stamp) - stamps.begin());
+        }
+
+        /**
+         * @brief Counts the elements equal to value
+         * @param value Value to count
+         * @return Number of equal elements
+         * Time Complexity: O(1) expected per match
+         */
+        size_t count(const T& value) const {
+            return map->count(value);
+        }
+
+        /**
+         * @brief Re-indexes every element from scratch
+         * @param elements The container's current elements
+         * Time Complexity: O(n) expected
+         */
+        template<typename Elements>
+        void rebuild(const Elements& elements) {
+            map->clear();
+            stamps.clear();
+            stamps.reserve(elements.size());
+            next_stamp = 0;
+            for (const T& value : elements) {
+                stamps.push_back(next_stamp);
+                map->insert(value, next_stamp++);
+            }
+            dirty.store(false, std::memory_order_release);
+        }
+
+        /**
+         * @brief Approximate heap memory held by the index
+         * @return Bytes used by the map and the stamp vector
+         * Time Complexity: O(1)
+         */
+        size_t memory_usage() const {
+            if (!map) return 0;
+            return map->memory_usage() + stamps.capacity() * sizeof(uint64_t);
+        }
+    };
+}
+}
@@ -10,13 +10,120 @@
 #define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
 #include "doctest.h"
 #include "../include/MyContainer.hpp"
+#include "../include/ConcurrentContainer.hpp"
 #include <stdexcept>
 #include <string>
 #include <vector>
 #include <sstream>
+#include <algorithm>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <list>
+#include <array>
+#include <iterator>
+#include <memory_resource>
+#include <cstddef>
+#include <fstream>
+#include <cstdio>
+#include <system_error>
+#include <unistd.h>
+#include <thread>
+#include <atomic>
 
 using namespace containers;
 
+namespace {
+    /**
+     * @brief Element type that counts how many comparisons were made
+     * Used to observe when the container actually sorts.
+     */
+    struct CountingInt {
+        int value;
+        static std::atomic<size_t> comparisons;
+
+        CountingInt(int v = 0) : value(v) {}
+
+        bool operator<(const CountingInt& other) const {
+            ++comparisons;
+            return value < other.value;
+        }
+        bool operator>(const CountingInt& other) const {
+            ++comparisons;
+            return value > other.value;
+        }
+        bool operator==(const CountingInt& other) const {
+            return value == other.value;
+        }
+    };
+
+    std::atomic<size_t> CountingInt::comparisons{0};
+
+    /**
+     * @brief Element type that counts how many times it was copied
+     * Used to check that iteration works on indices only.
+     */
+    struct CopyCounter {
+        std::string value;
+        static size_t copies;
+
+        CopyCounter(const char* v) : value(v) {}
+        CopyCounter(const CopyCounter& other) : value(other.value) { ++copies; }
+        CopyCounter(CopyCounter&& other) noexcept : value(std::move(other.value)) {}
+        CopyCounter& operator=(CopyCounter&& other) noexcept {
+            value = std::move(other.value);
+            return *this;
+        }
+        CopyCounter& operator=(const CopyCounter& other) {
+            value = other.value;
+            ++copies;
+            return *this;
+        }
+
+        bool operator<(const CopyCounter& other) const { return value < other.value; }
+        bool operator>(const CopyCounter& other) const { return value > other.value; }
+        bool operator==(const CopyCounter& other) const { return value == other.value; }
+    };
+
+    size_t CopyCounter::copies = 0;
+
+    /**
+     * @brief Checks that ascending iteration equals a stable sort of the input
+     * Compares bit patterns so that ties such as -0.0 and +0.0 must keep
+     * their insertion order.
+     */
+    template<typename T>
+    void check_ascending_matches_stable_sort(const std::vector<T>& values) {
+        MyContainer<T> container;
+        for (const T& val : values) {
+            container.add(val);
+        }
+        std::vector<T> expected(values);
+        std::stable_sort(expected.begin(), expected.end());
+
+        std::vector<T> ascending;
+        for (const auto& val : container.ascending_order()) ascending.push_back(val);
+        REQUIRE(ascending.size() == expected.size());
+        CHECK(std::memcmp(ascending.data(), expected.data(), sizeof(T) * expected.size()) == 0);
+    }
+
+    /**
+     * @brief Deterministic pseudo-random bit patterns for the radix tests
+     */
+    std::vector<uint64_t> random_bits(size_t count) {
+        std::vector<uint64_t> bits;
+        uint64_t state = 0x9E3779B97F4A7C15ull;
+        for (size_t i = 0; i < count; ++i) {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            bits.push_back(state);
+        }
+        return bits;
+    }
+}
+
 TEST_CASE("Basic Container Operations") {
     MyContainer<int> container;
 
@@ -62,6 +169,19 @@ TEST_CASE("Basic Container Operations") {
         CHECK(const_container[0] == 1);
         CHECK_THROWS_AS(const_container[1], std::out_of_range);
     }
+
+    SUBCASE("Checked at access") {
+        container.add(5);
+        container.add(2);
+        const MyContainer<int>& const_container = container;
+        CHECK(const_container.at(1) == 2);
+        CHECK_THROWS_AS(const_container.at(2), std::out_of_range);
+        CHECK_THROWS_AS(container.at(2), std::out_of_range);
+
+        CHECK(*container.ascending_order() == 2);
+        container.at(1) = 9;
+        CHECK(*container.ascending_order() == 5);
+    }
 }
 
 TEST_CASE("Output Stream Operator") {
@@ -81,6 +201,85 @@ TEST_CASE("Output Stream Operator") {
         ss << container;
         CHECK(ss.str() == "[1,2,3]");
     }
+
+    SUBCASE("Matches per-element stream formatting") {
+        auto reference = [](const auto& view) {
+            std::ostringstream os;
+            os << "[";
+            bool first = true;
+            for (const auto& val : view) {
+                if (!first) os << ",";
+                os << val;
+                first = false;
+            }
+            os << "]";
+            return os.str();
+        };
+
+        for (int i = 0; i < 50000; ++i) container.add((i * 7919) % 100003 - 50000);
+        container.add(std::numeric_limits<int>::min());
+        std::ostringstream os;
+        os << container;
+        CHECK(os.str() == reference(container.order()));
+        CHECK(os.str().size() > 64 * 1024);
+
+        MyContainer<double> reals = {3.14159265358979, -0.0, 1e-300, 2.5e10, 100.0, 1.0 / 3.0};
+        std::ostringstream precise;
+        precise.precision(12);
+        precise << reals;
+        std::ostringstream expected;
+        expected.precision(12);
+        expected << "[";
+        for (size_t i = 0; i < reals.size(); ++i) expected << (i ? "," : "") << reals[i];
+        expected << "]";
+        CHECK(precise.str() == expected.str());
+
+        MyContainer<std::string> words = {"pear", "", "fig"};
+        std::ostringstream text;
+        text << words;
+        CHECK(text.str() == "[pear,,fig]");
+
+        MyContainer<char> letters = {'b', 'a'};
+        std::ostringstream chars;
+        chars << letters;
+        CHECK(chars.str() == "[b,a]");
+    }
+
+    SUBCASE("Stream formatting flags are honoured") {
+        container.add(255);
+        container.add(16);
+        std::ostringstream os;
+        os << std::hex << container;
+        CHECK(os.str() == "[ff,10]");
+    }
+
+    SUBCASE("Any order to any destination") {
+        for (int value : {5, 1, 4, 2, 3}) container.add(value);
+        std::ostringstream os;
+        container.write_to(os, container.ascending_order());
+        CHECK(os.str() == "[1,2,3,4,5]");
+
+        std::FILE* file = std::tmpfile();
+        REQUIRE(file != nullptr);
+        container.write_to(file, container.side_cross_order());
+        container.write_to(file);
+        std::rewind(file);
+        char buffer[64] = {};
+        size_t got = std::fread(buffer, 1, sizeof(buffer) - 1, file);
+        std::fclose(file);
+        CHECK(std::string(buffer, got) == "[1,5,2,4,3][5,1,4,2,3]");
+
+        int fds[2];
+        REQUIRE(::pipe(fds) == 0);
+        container.write_to(fds[1], container.middle_out_order());
+        container.write_to(fds[1], container.descending_order());
+        ::close(fds[1]);
+        std::string piped;
+        ssize_t n;
+        while ((n = ::read(fds[0], buffer, sizeof(buffer))) > 0) piped.append(buffer, static_cast<size_t>(n));
+        ::close(fds[0]);
+        CHECK(piped == "[4,1,2,5,3][5,4,3,2,1]");
+    }
 }
 
 TEST_CASE("Iterator Functionality") {
@@ -361,6 +560,29 @@ TEST_CASE("Middle Out Special Cases") {
         }
         CHECK(i == expected.size());
     }
+
+    SUBCASE("Every size visits each element once, nearest to the middle first") {
+        for (int n = 1; n <= 9; ++n) {
+            container.add(n - 1);
+            std::vector<int> visited;
+            for (const auto& val : container.middle_out_order()) {
+                visited.push_back(val);
+            }
+            REQUIRE(visited.size() == static_cast<size_t>(n));
+
+            std::vector<int> sorted_visit(visited);
+            std::sort(sorted_visit.begin(), sorted_visit.end());
+            for (int i = 0; i < n; ++i) {
+                CHECK(sorted_visit[i] == i);
+            }
+
+            // Left-middle for even sizes, exact middle for odd sizes
+            CHECK(visited[0] == (n % 2 == 0 ? n / 2 - 1 : n / 2));
+            for (int k = 1; k < n; ++k) {
+                CHECK(std::abs(2 * visited[k] - (n - 1)) >= std::abs(2 * visited[k - 1] - (n - 1)));
+            }
+        }
+    }
 }
 
 TEST_CASE("Edge Cases") {
@@ -502,4 +724,1731 @@ TEST_CASE("Iterator Multiple Operations") {
         CHECK(*it1 == 2);
         CHECK(*it2 == 1);
     }
-}
\ No newline at end of file
+}
+
+TEST_CASE("Sorted View Cache") {
+    MyContainer<int> container;
+    std::vector<int> values = {5, 3, 8, 1};
+    for (int val : values) {
+        container.add(val);
+    }
+
+    SUBCASE("Views over unchanged data agree") {
+        std::vector<int> ascending;
+        for (const auto& val : container.ascending_order()) ascending.push_back(val);
+        std::vector<int> descending;
+        for (const auto& val : container.descending_order()) descending.push_back(val);
+        std::vector<int> cross;
+        for (const auto& val : container.side_cross_order()) cross.push_back(val);
+
+        CHECK(ascending == std::vector<int>{1, 3, 5, 8});
+        CHECK(descending == std::vector<int>{8, 5, 3, 1});
+        CHECK(cross == std::vector<int>{1, 8, 3, 5});
+    }
+
+    SUBCASE("Add invalidates the cache") {
+        CHECK(*container.ascending_order() == 1);
+        container.add(0);
+        CHECK(*container.ascending_order() == 0);
+        CHECK(*container.descending_order() == 8);
+    }
+
+    SUBCASE("Remove invalidates the cache") {
+        CHECK(*container.descending_order() == 8);
+        container.remove(8);
+        CHECK(*container.descending_order() == 5);
+        CHECK(*container.side_cross_order() == 1);
+    }
+
+    SUBCASE("Non-const access invalidates the cache") {
+        CHECK(*container.ascending_order() == 1);
+        container[3] = 10;
+        CHECK(*container.ascending_order() == 3);
+        CHECK(*container.descending_order() == 10);
+    }
+
+    SUBCASE("Copies carry a valid cache") {
+        CHECK(*container.ascending_order() == 1);
+        MyContainer<int> copy(container);
+        copy.add(-1);
+        CHECK(*copy.ascending_order() == -1);
+        CHECK(*container.ascending_order() == 1);
+    }
+
+    SUBCASE("Equal elements keep insertion order") {
+        MyContainer<int> dup;
+        dup.add(2);
+        dup.add(1);
+        dup.add(2);
+        dup.add(1);
+        std::vector<int> ascending;
+        for (const auto& val : dup.ascending_order()) ascending.push_back(val);
+        CHECK(ascending == std::vector<int>{1, 1, 2, 2});
+    }
+}
+
+
+TEST_CASE("Deferred Permutation Construction") {
+    MyContainer<CountingInt> container;
+    for (int val : {4, 2, 7, 1, 9, 3}) {
+        container.add(val);
+    }
+
+    SUBCASE("Views that are never read do not sort") {
+        CountingInt::comparisons = 0;
+        auto asc = container.ascending_order();
+        auto desc = container.descending_order();
+        auto cross = container.side_cross_order();
+        CHECK(asc.begin() != asc.end());
+        CHECK(desc.begin() != desc.end());
+        CHECK(cross.begin() != cross.end());
+        CHECK(CountingInt::comparisons == 0);
+    }
+
+    SUBCASE("A range-for sorts once and reuses the result") {
+        CountingInt::comparisons = 0;
+        std::vector<int> ascending;
+        for (const auto& val : container.ascending_order()) ascending.push_back(val.value);
+        CHECK(ascending == std::vector<int>{1, 2, 3, 4, 7, 9});
+
+        size_t after_first = CountingInt::comparisons;
+        CHECK(after_first > 0);
+
+        std::vector<int> descending;
+        for (const auto& val : container.descending_order()) descending.push_back(val.value);
+        std::vector<int> cross;
+        for (const auto& val : container.side_cross_order()) cross.push_back(val.value);
+        CHECK(descending == std::vector<int>{9, 7, 4, 3, 2, 1});
+        CHECK(cross == std::vector<int>{1, 9, 2, 7, 3, 4});
+        CHECK(CountingInt::comparisons == after_first);
+    }
+
+    SUBCASE("End iterators still throw on dereference") {
+        auto asc = container.ascending_order();
+        CHECK_THROWS_AS(*asc.end(), std::out_of_range);
+        auto middle = container.middle_out_order();
+        CHECK_THROWS_AS(*middle.end(), std::out_of_range);
+    }
+}
+
+TEST_CASE("Side Cross Order Over Indices") {
+    SUBCASE("Odd and even sizes alternate ends") {
+        MyContainer<int> container;
+        for (int val : {6, 2, 9, 4, 7}) {
+            container.add(val);
+        }
+        std::vector<int> odd;
+        for (const auto& val : container.side_cross_order()) odd.push_back(val);
+        CHECK(odd == std::vector<int>{2, 9, 4, 7, 6});
+
+        container.add(1);
+        std::vector<int> even;
+        for (const auto& val : container.side_cross_order()) even.push_back(val);
+        CHECK(even == std::vector<int>{1, 9, 2, 7, 4, 6});
+    }
+
+    SUBCASE("Elements are never copied") {
+        MyContainer<CopyCounter> container;
+        for (const char* val : {"pear", "apple", "fig", "kiwi"}) {
+            container.add(val);
+        }
+
+        CopyCounter::copies = 0;
+        std::vector<std::string> visited;
+        for (const auto& val : container.side_cross_order()) visited.push_back(val.value);
+        CHECK(visited == std::vector<std::string>{"apple", "pear", "fig", "kiwi"});
+        CHECK(CopyCounter::copies == 0);
+    }
+}
+
+TEST_CASE("Incremental Sort Mode") {
+    // Deterministic pseudo-random values with plenty of duplicates
+    std::vector<int> values;
+    unsigned seed = 12345;
+    for (int i = 0; i < 5000; ++i) {
+        seed = seed * 1103515245u + 12345u;
+        values.push_back(static_cast<int>((seed >> 16) % 1000));
+    }
+    std::vector<int> sorted(values);
+    std::sort(sorted.begin(), sorted.end());
+
+    MyContainer<int> container;
+    for (int val : values) {
+        container.add(val);
+    }
+
+    SUBCASE("Mode defaults to Full and can be switched") {
+        CHECK(container.sort_mode() == SortMode::Full);
+        container.set_sort_mode(SortMode::Incremental);
+        CHECK(container.sort_mode() == SortMode::Incremental);
+    }
+
+    SUBCASE("All sorted views match a full sort") {
+        container.set_sort_mode(SortMode::Incremental);
+
+        std::vector<int> descending;
+        for (const auto& val : container.descending_order()) descending.push_back(val);
+        CHECK(descending == std::vector<int>(sorted.rbegin(), sorted.rend()));
+
+        container.add(-1);
+        sorted.insert(sorted.begin(), -1);
+
+        std::vector<int> ascending;
+        for (const auto& val : container.ascending_order()) ascending.push_back(val);
+        CHECK(ascending == sorted);
+
+        container.add(2000);
+        sorted.push_back(2000);
+
+        std::vector<int> cross;
+        for (const auto& val : container.side_cross_order()) cross.push_back(val);
+        REQUIRE(cross.size() == sorted.size());
+        for (size_t k = 0; k < cross.size(); ++k) {
+            size_t rank = k % 2 == 0 ? k / 2 : sorted.size() - 1 - k / 2;
+            CHECK(cross[k] == sorted[rank]);
+        }
+    }
+
+    SUBCASE("Reading a short prefix does far less work than a full sort") {
+        MyContainer<CountingInt> full_sort;
+        MyContainer<CountingInt> counted;
+        for (int val : values) {
+            full_sort.add(val);
+            counted.add(val);
+        }
+
+        CountingInt::comparisons = 0;
+        CHECK((*full_sort.ascending_order()).value == sorted[0]);
+        size_t full = CountingInt::comparisons;
+
+        counted.set_sort_mode(SortMode::Incremental);
+        CountingInt::comparisons = 0;
+        auto it = counted.ascending_order();
+        for (int i = 0; i < 10; ++i, ++it) {
+            CHECK((*it).value == sorted[i]);
+        }
+        auto desc = counted.descending_order();
+        for (int i = 0; i < 10; ++i, ++desc) {
+            CHECK((*desc).value == sorted[sorted.size() - 1 - i]);
+        }
+        CHECK(CountingInt::comparisons * 2 < full);
+    }
+}
+
+TEST_CASE("Radix Sort For Arithmetic Types") {
+    const size_t SIZE = 3000;
+    std::vector<uint64_t> bits = random_bits(SIZE);
+
+    SUBCASE("Signed and unsigned integers") {
+        std::vector<int> ints;
+        std::vector<int64_t> longs;
+        std::vector<uint64_t> ulongs;
+        std::vector<char> chars;
+        for (uint64_t b : bits) {
+            ints.push_back(static_cast<int>(b % 2001) - 1000);
+            longs.push_back(static_cast<int64_t>(b));
+            ulongs.push_back(b >> (b % 64));
+            chars.push_back(static_cast<char>(b));
+        }
+        ints.push_back(std::numeric_limits<int>::min());
+        ints.push_back(std::numeric_limits<int>::max());
+        check_ascending_matches_stable_sort(ints);
+        check_ascending_matches_stable_sort(longs);
+        check_ascending_matches_stable_sort(ulongs);
+        check_ascending_matches_stable_sort(chars);
+    }
+
+    SUBCASE("Floating point values") {
+        std::vector<float> floats;
+        std::vector<double> doubles;
+        for (uint64_t b : bits) {
+            double d = (static_cast<double>(b % 20001) - 10000.0) / 7.0;
+            doubles.push_back(d);
+            floats.push_back(static_cast<float>(d));
+        }
+        for (int i = 0; i < 10; ++i) {
+            doubles.push_back(i % 2 == 0 ? -0.0 : 0.0);
+            floats.push_back(i % 2 == 0 ? 0.0f : -0.0f);
+        }
+        doubles.push_back(std::numeric_limits<double>::infinity());
+        doubles.push_back(-std::numeric_limits<double>::infinity());
+        doubles.push_back(std::numeric_limits<double>::denorm_min());
+        floats.push_back(-std::numeric_limits<float>::infinity());
+        floats.push_back(std::numeric_limits<float>::lowest());
+        check_ascending_matches_stable_sort(floats);
+        check_ascending_matches_stable_sort(doubles);
+    }
+
+    SUBCASE("Descending and side cross use the same permutation") {
+        MyContainer<double> container;
+        std::vector<double> values;
+        for (uint64_t b : bits) {
+            values.push_back(static_cast<double>(b % 5000) - 2500.5);
+            container.add(values.back());
+        }
+        std::sort(values.begin(), values.end());
+
+        std::vector<double> descending;
+        for (const auto& val : container.descending_order()) descending.push_back(val);
+        CHECK(descending == std::vector<double>(values.rbegin(), values.rend()));
+
+        std::vector<double> cross;
+        for (const auto& val : container.side_cross_order()) cross.push_back(val);
+        CHECK(cross.front() == values.front());
+        CHECK(cross[1] == values.back());
+    }
+}
+
+TEST_CASE("Parallel Sorted Views") {
+    const size_t SIZE = 100000;
+    std::vector<uint64_t> bits = random_bits(SIZE);
+
+    SUBCASE("Integers match the sequential permutation") {
+        MyContainer<int> sequential;
+        for (uint64_t b : bits) {
+            sequential.add(static_cast<int>(b % 1000));
+        }
+        const MyContainer<int>& seq = sequential;
+        std::vector<size_t> expected;
+        for (const auto& val : seq.ascending_order()) {
+            expected.push_back(static_cast<size_t>(&val - &seq[0]));
+        }
+
+        for (unsigned threads : {2u, 3u, 4u}) {
+            MyContainer<int> parallel;
+            for (uint64_t b : bits) {
+                parallel.add(static_cast<int>(b % 1000));
+            }
+            const MyContainer<int>& par = parallel;
+            std::vector<size_t> actual;
+            for (auto it = par.ascending_order(execution::par(threads)); it != it.end(); ++it) {
+                actual.push_back(static_cast<size_t>(&*it - &par[0]));
+            }
+            CHECK(actual == expected);
+        }
+    }
+
+    SUBCASE("Strings match the sequential order in every view") {
+        MyContainer<std::string> container;
+        std::vector<std::string> values;
+        for (uint64_t b : bits) {
+            values.push_back(std::to_string(b % 50000));
+            container.add(values.back());
+        }
+        std::sort(values.begin(), values.end());
+
+        std::vector<std::string> ascending;
+        for (auto it = container.ascending_order(execution::par(4)); it != it.end(); ++it) {
+            ascending.push_back(*it);
+        }
+        CHECK(ascending == values);
+
+        std::vector<std::string> descending;
+        for (auto it = container.descending_order(execution::par); it != it.end(); ++it) {
+            descending.push_back(*it);
+        }
+        CHECK(descending == std::vector<std::string>(values.rbegin(), values.rend()));
+
+        auto cross = container.side_cross_order(execution::par(2));
+        CHECK(*cross == values.front());
+        ++cross;
+        CHECK(*cross == values.back());
+    }
+
+    SUBCASE("A parallel build is reused by later views") {
+        MyContainer<CountingInt> container;
+        for (uint64_t b : bits) {
+            container.add(static_cast<int>(b % 100000));
+        }
+        auto asc = container.ascending_order(execution::par(4));
+        size_t after_build = CountingInt::comparisons;
+        CHECK((*asc).value <= (*container.descending_order()).value);
+        CHECK(CountingInt::comparisons == after_build);
+    }
+
+    SUBCASE("A throwing comparison reaches the caller") {
+        std::vector<size_t> tasks_run(64, 0);
+        CHECK_THROWS_WITH_AS(detail::run_tasks(64, 4, [&tasks_run](size_t i) {
+            ++tasks_run[i];
+            if (i == 3) throw std::runtime_error("task failed");
+        }), "task failed", std::runtime_error);
+        CHECK(std::count(tasks_run.begin(), tasks_run.end(), size_t(2)) == 0);
+
+        std::vector<int> values(SIZE);
+        for (size_t i = 0; i < SIZE; ++i) values[i] = static_cast<int>(bits[i] % 1000);
+        std::atomic<size_t> calls{0};
+        CHECK_THROWS_WITH_AS(detail::parallel_sort(values.begin(), values.end(),
+            [&calls](int a, int b) {
+                if (++calls == 50000) throw std::runtime_error("comparison failed");
+                return a < b;
+            },
+            [](auto first, auto last) { std::sort(first, last); }, 4), "comparison failed", std::runtime_error);
+        std::sort(values.begin(), values.end());
+        CHECK(values.size() == SIZE);
+    }
+
+    SUBCASE("Merges split evenly across threads") {
+        std::vector<int> values(SIZE);
+        for (size_t i = 0; i < SIZE; ++i) values[i] = static_cast<int>(bits[i] % 1000);
+        std::vector<int> expected = values;
+        std::stable_sort(expected.begin(), expected.end());
+        for (unsigned threads : {2u, 5u, 8u}) {
+            std::vector<int> actual = values;
+            detail::parallel_sort(actual.begin(), actual.end(), std::less<int>(),
+                                  [](auto first, auto last) { std::sort(first, last); }, threads);
+            CHECK(actual == expected);
+        }
+    }
+
+    SUBCASE("Small containers sort on the calling thread") {
+        MyContainer<int> container;
+        container.add(3);
+        container.add(1);
+        container.add(2);
+        std::vector<int> ascending;
+        for (auto it = container.ascending_order(execution::par); it != it.end(); ++it) {
+            ascending.push_back(*it);
+        }
+        CHECK(ascending == std::vector<int>{1, 2, 3});
+    }
+}
+
+TEST_CASE("Move Semantics") {
+    SUBCASE("Move construction steals the elements") {
+        MyContainer<CopyCounter> source;
+        source.emplace("beta");
+        source.emplace("alpha");
+        CHECK(*source.ascending_order() == CopyCounter("alpha"));
+
+        CopyCounter::copies = 0;
+        MyContainer<CopyCounter> target(std::move(source));
+        CHECK(CopyCounter::copies == 0);
+        CHECK(target.size() == 2);
+        CHECK(source.size() == 0);
+        CHECK(target[0].value == "beta");
+        CHECK((*target.ascending_order()).value == "alpha");
+
+        auto empty = source.ascending_order();
+        CHECK(empty.begin() == empty.end());
+        source.add("gamma");
+        CHECK((*source.ascending_order()).value == "gamma");
+    }
+
+    SUBCASE("Move assignment replaces the elements") {
+        MyContainer<std::string> source;
+        source.add("x");
+        source.add("a");
+        MyContainer<std::string> target;
+        target.add("old");
+        CHECK(*target.descending_order() == "old");
+
+        target = std::move(source);
+        CHECK(target.size() == 2);
+        CHECK(source.size() == 0);
+        CHECK(*target.descending_order() == "x");
+        CHECK(*target.ascending_order() == "a");
+    }
+
+    SUBCASE("Rvalues and emplace do not copy") {
+        MyContainer<CopyCounter> container;
+        CopyCounter::copies = 0;
+        CopyCounter value("moved");
+        container.add(std::move(value));
+        container.add(CopyCounter("temporary"));
+        container.emplace("emplaced");
+        CHECK(CopyCounter::copies == 0);
+        CHECK(container.size() == 3);
+        CHECK(container[2].value == "emplaced");
+    }
+
+    SUBCASE("Returning a container by value does not copy") {
+        auto make = []() {
+            MyContainer<CopyCounter> local;
+            local.emplace("one");
+            local.emplace("two");
+            return local;
+        };
+        CopyCounter::copies = 0;
+        MyContainer<CopyCounter> result = make();
+        CHECK(CopyCounter::copies == 0);
+        CHECK(result.size() == 2);
+    }
+
+    SUBCASE("Emplace invalidates the sorted cache") {
+        MyContainer<std::string> container;
+        container.add("m");
+        CHECK(*container.ascending_order() == "m");
+        container.emplace(3, 'a');
+        CHECK(*container.ascending_order() == "aaa");
+    }
+}
+
+TEST_CASE("Bulk Construction and Append") {
+    SUBCASE("Initializer list") {
+        MyContainer<int> container{4, 1, 3};
+        CHECK(container.size() == 3);
+        CHECK(container.capacity() == 3);
+        CHECK(*container.ascending_order() == 1);
+    }
+
+    SUBCASE("Iterator pair") {
+        std::list<std::string> source = {"b", "c", "a"};
+        MyContainer<std::string> container(source.begin(), source.end());
+        CHECK(container.size() == 3);
+        CHECK(container.capacity() == 3);
+        CHECK(container[2] == "a");
+    }
+
+    SUBCASE("Sized ranges are copied, rvalue ranges are moved") {
+        std::vector<CopyCounter> source = {"x", "y", "z"};
+        CopyCounter::copies = 0;
+        MyContainer<CopyCounter> copied(source);
+        CHECK(CopyCounter::copies == 3);
+        CHECK(copied.capacity() == 3);
+
+        CopyCounter::copies = 0;
+        MyContainer<CopyCounter> moved(std::move(source));
+        CHECK(CopyCounter::copies == 0);
+        CHECK(moved.size() == 3);
+        CHECK(moved[1].value == "y");
+
+        std::array<int, 4> values = {7, 5, 9, 6};
+        MyContainer<int> from_array(values);
+        CHECK(*from_array.descending_order() == 9);
+    }
+
+    SUBCASE("Append allocates once for forward ranges") {
+        MyContainer<int> container{1, 2};
+        std::vector<int> more(1000);
+        for (int i = 0; i < 1000; ++i) more[i] = -i;
+
+        CHECK(*container.ascending_order() == 1);
+        container.append(more.begin(), more.end());
+        CHECK(container.size() == 1002);
+        CHECK(container[2] == 0);
+        CHECK(*container.ascending_order() == -999);
+    }
+
+    SUBCASE("Append from a single-pass input range") {
+        std::istringstream input("3 1 2");
+        MyContainer<int> container;
+        container.append(std::istream_iterator<int>(input), std::istream_iterator<int>());
+        CHECK(container.size() == 3);
+        CHECK(*container.ascending_order() == 1);
+    }
+
+    SUBCASE("Reserve and capacity") {
+        MyContainer<int> container;
+        container.reserve(100);
+        CHECK(container.capacity() >= 100);
+        const size_t reserved = container.capacity();
+        for (int i = 0; i < 100; ++i) container.add(i);
+        CHECK(container.capacity() == reserved);
+    }
+}
+
+TEST_CASE("Unordered Removal") {
+    MyContainer<int> container{5, 1, 4, 2, 3};
+
+    SUBCASE("The last element fills the removed slot") {
+        container.remove_unordered(1);
+        CHECK(container.size() == 4);
+        std::vector<int> inserted;
+        for (const auto& val : container.order()) inserted.push_back(val);
+        CHECK(inserted == std::vector<int>{5, 3, 4, 2});
+        std::vector<int> reversed;
+        for (const auto& val : container.reverse_order()) reversed.push_back(val);
+        CHECK(reversed == std::vector<int>{2, 4, 3, 5});
+    }
+
+    SUBCASE("Removing the last element just drops it") {
+        container.remove_unordered(3);
+        CHECK(container.size() == 4);
+        CHECK(container[3] == 2);
+    }
+
+    SUBCASE("Sorted views see the removal") {
+        CHECK(*container.ascending_order() == 1);
+        container.remove_unordered(1);
+        CHECK(*container.ascending_order() == 2);
+        container.remove_unordered(5);
+        CHECK(*container.descending_order() == 4);
+    }
+
+    SUBCASE("Missing elements throw") {
+        CHECK_THROWS_AS(container.remove_unordered(9), std::runtime_error);
+        MyContainer<int> empty;
+        CHECK_THROWS_AS(empty.remove_unordered(1), std::runtime_error);
+    }
+}
+
+TEST_CASE("Hash Index") {
+    MyContainer<int> container{4, 8, 4, 1, 9, 4};
+
+    SUBCASE("Lookups work with and without the index") {
+        CHECK_FALSE(container.has_hash_index());
+        CHECK(container.contains(8));
+        CHECK(container.count(4) == 3);
+        CHECK_FALSE(container.contains(5));
+
+        container.enable_hash_index();
+        CHECK(container.has_hash_index());
+        CHECK(container.contains(8));
+        CHECK(container.count(4) == 3);
+        CHECK(container.count(5) == 0);
+
+        container.disable_hash_index();
+        CHECK_FALSE(container.has_hash_index());
+        CHECK(container.count(4) == 3);
+    }
+
+    SUBCASE("Remove takes the first occurrence and keeps order") {
+        container.enable_hash_index();
+        container.remove(4);
+        std::vector<int> inserted;
+        for (const auto& val : container.order()) inserted.push_back(val);
+        CHECK(inserted == std::vector<int>{8, 4, 1, 9, 4});
+        CHECK(container.count(4) == 2);
+        CHECK_THROWS_AS(container.remove(5), std::runtime_error);
+    }
+
+    SUBCASE("Unordered removal restamps the moved element") {
+        container.enable_hash_index();
+        container.remove_unordered(8);
+        CHECK(container[1] == 4);
+        container.remove(4);
+        container.remove(4);
+        std::vector<int> inserted;
+        for (const auto& val : container.order()) inserted.push_back(val);
+        CHECK(inserted == std::vector<int>{4, 1, 9});
+    }
+
+    SUBCASE("Non-const access marks the index stale") {
+        container.enable_hash_index();
+        container[1] = 7;
+        CHECK_FALSE(container.contains(8));
+        CHECK(container.contains(7));
+        container.add(8);
+        container.remove(7);
+        CHECK(container.count(8) == 1);
+        CHECK(container[4] == 4);
+    }
+
+    SUBCASE("Random operations agree with a linear reference") {
+        std::vector<uint64_t> bits = random_bits(4000);
+        MyContainer<int> indexed;
+        indexed.enable_hash_index();
+        std::vector<int> reference;
+        for (uint64_t b : bits) {
+            int value = static_cast<int>(b % 200);
+            if (b % 3 == 0 && indexed.contains(value)) {
+                auto it = std::find(reference.begin(), reference.end(), value);
+                if (b % 2 == 0) {
+                    reference.erase(it);
+                    indexed.remove(value);
+                } else {
+                    *it = reference.back();
+                    reference.pop_back();
+                    indexed.remove_unordered(value);
+                }
+            } else {
+                reference.push_back(value);
+                indexed.add(value);
+            }
+            CHECK(indexed.count(value) == static_cast<size_t>(std::count(reference.begin(), reference.end(), value)));
+        }
+        std::vector<int> inserted;
+        for (const auto& val : indexed.order()) inserted.push_back(val);
+        CHECK(inserted == reference);
+    }
+
+    SUBCASE("Copies own their index and memory usage is reported") {
+        size_t without = container.memory_usage();
+        container.enable_hash_index();
+        CHECK(container.memory_usage() > without);
+
+        MyContainer<int> copy(container);
+        copy.remove(9);
+        CHECK(copy.has_hash_index());
+        CHECK_FALSE(copy.contains(9));
+        CHECK(container.contains(9));
+
+        MyContainer<int> moved(std::move(copy));
+        CHECK(moved.has_hash_index());
+        CHECK_FALSE(copy.has_hash_index());
+        CHECK(moved.count(4) == 3);
+    }
+
+    SUBCASE("Appended ranges and custom hashes") {
+        struct Mod10 {
+            size_t operator()(int v) const { return static_cast<size_t>(v % 10); }
+        };
+        container.enable_hash_index<Mod10>();
+        std::vector<int> more = {14, 24, 4};
+        container.append(more.begin(), more.end());
+        CHECK(container.count(4) == 4);
+        CHECK(container.count(24) == 1);
+    }
+}
+
+TEST_CASE("Batch Removal") {
+    MyContainer<int> container{3, 1, 3, 2, 5, 3, 4};
+
+    auto contents = [](const MyContainer<int>& c) {
+        std::vector<int> out;
+        for (const auto& val : c.order()) out.push_back(val);
+        return out;
+    };
+
+    SUBCASE("remove_all") {
+        CHECK(container.remove_all(3) == 3);
+        CHECK(contents(container) == std::vector<int>{1, 2, 5, 4});
+        CHECK(container.remove_all(9) == 0);
+        CHECK(container.size() == 4);
+    }
+
+    SUBCASE("remove_if") {
+        CHECK(*container.descending_order() == 5);
+        CHECK(container.remove_if([](int v) { return v > 2; }) == 5);
+        CHECK(contents(container) == std::vector<int>{1, 2});
+        CHECK(*container.descending_order() == 2);
+    }
+
+    SUBCASE("remove_many removes one occurrence per listed value") {
+        std::vector<int> values = {3, 4, 3};
+        container.remove_many(values);
+        CHECK(contents(container) == std::vector<int>{1, 2, 5, 3});
+    }
+
+    SUBCASE("remove_many leaves the container unchanged on failure") {
+        std::vector<int> values = {1, 9};
+        CHECK_THROWS_AS(container.remove_many(values), std::runtime_error);
+        std::vector<int> too_many = {1, 1};
+        CHECK_THROWS_AS(container.remove_many(too_many), std::runtime_error);
+        CHECK(container.size() == 7);
+        container.remove_many(std::vector<int>{});
+        CHECK(container.size() == 7);
+    }
+
+    SUBCASE("erase by index range") {
+        container.erase(1, 4);
+        CHECK(contents(container) == std::vector<int>{3, 5, 3, 4});
+        container.erase(2, 2);
+        CHECK(container.size() == 4);
+        CHECK_THROWS_AS(container.erase(3, 2), std::out_of_range);
+        CHECK_THROWS_AS(container.erase(0, 5), std::out_of_range);
+    }
+
+    SUBCASE("The hash index follows batch removals") {
+        container.enable_hash_index();
+        container.remove_all(3);
+        CHECK_FALSE(container.contains(3));
+        container.erase(0, 1);
+        CHECK_FALSE(container.contains(1));
+        container.add(1);
+        container.remove_many(std::vector<int>{5, 1});
+        CHECK(contents(container) == std::vector<int>{2, 4});
+        CHECK(container.count(2) == 1);
+    }
+}
+
+TEST_CASE("Maintained Sort Mode") {
+    auto ascending = [](const MyContainer<int>& c) {
+        std::vector<int> out;
+        for (const auto& val : c.ascending_order()) out.push_back(val);
+        return out;
+    };
+
+    SUBCASE("Interleaved adds, removals and reads stay sorted") {
+        MyContainer<int> container;
+        container.set_sort_mode(SortMode::Maintained);
+        std::vector<int> reference;
+        std::vector<uint64_t> bits = random_bits(3000);
+        for (size_t i = 0; i < bits.size(); ++i) {
+            int value = static_cast<int>(bits[i] % 500);
+            if (bits[i] % 4 == 0 && container.contains(value)) {
+                reference.erase(std::find(reference.begin(), reference.end(), value));
+                if (bits[i] % 8 == 0) {
+                    container.remove(value);
+                } else {
+                    container.remove_unordered(value);
+                }
+            } else {
+                container.add(value);
+                reference.push_back(value);
+            }
+            if (i % 250 == 0) {
+                std::vector<int> expected(reference);
+                std::sort(expected.begin(), expected.end());
+                CHECK(ascending(container) == expected);
+                CHECK(*container.descending_order() == expected.back());
+            }
+        }
+        std::sort(reference.begin(), reference.end());
+        CHECK(ascending(container) == reference);
+    }
+
+    SUBCASE("Reads after add do not sort") {
+        MyContainer<CountingInt> container;
+        container.set_sort_mode(SortMode::Maintained);
+        for (int i = 0; i < 5000; ++i) {
+            container.add((i * 7919) % 5003);
+        }
+        CHECK((*container.ascending_order()).value == 0);
+
+        CountingInt::comparisons = 0;
+        container.add(-5);
+        container.emplace(100000);
+        CHECK(CountingInt::comparisons < 200);
+
+        CountingInt::comparisons = 0;
+        CHECK((*container.ascending_order()).value == -5);
+        CHECK((*container.descending_order()).value == 100000);
+        auto cross = container.side_cross_order();
+        ++cross;
+        CHECK((*cross).value == 100000);
+        CHECK(CountingInt::comparisons == 0);
+    }
+
+    SUBCASE("Changes the structure cannot follow trigger a rebuild") {
+        MyContainer<int> container{5, 3, 9, 1};
+        container.set_sort_mode(SortMode::Maintained);
+        CHECK(ascending(container) == std::vector<int>{1, 3, 5, 9});
+        container[0] = 0;
+        CHECK(ascending(container) == std::vector<int>{0, 1, 3, 9});
+        container.remove_if([](int v) { return v == 3; });
+        CHECK(ascending(container) == std::vector<int>{0, 1, 9});
+        std::vector<int> more = {4, 2};
+        container.append(more.begin(), more.end());
+        CHECK(ascending(container) == std::vector<int>{0, 1, 2, 4, 9});
+    }
+
+    SUBCASE("Switching modes keeps views correct") {
+        MyContainer<int> container{5, 3, 9, 1};
+        CHECK(*container.ascending_order() == 1);
+        container.set_sort_mode(SortMode::Maintained);
+        container.add(0);
+        CHECK(ascending(container) == std::vector<int>{0, 1, 3, 5, 9});
+        container.set_sort_mode(SortMode::Full);
+        container.add(4);
+        CHECK(ascending(container) == std::vector<int>{0, 1, 3, 4, 5, 9});
+        container.set_sort_mode(SortMode::Maintained);
+        CHECK(*container.ascending_order(execution::par(2)) == 0);
+        container.remove(0);
+        CHECK(ascending(container) == std::vector<int>{1, 3, 4, 5, 9});
+    }
+
+    SUBCASE("Insertion order is unaffected") {
+        MyContainer<int> container;
+        container.set_sort_mode(SortMode::Maintained);
+        for (int val : {4, 2, 8, 6}) container.add(val);
+        CHECK(*container.ascending_order() == 2);
+        container.remove(2);
+        std::vector<int> inserted;
+        for (const auto& val : container.order()) inserted.push_back(val);
+        CHECK(inserted == std::vector<int>{4, 8, 6});
+    }
+}
+
+TEST_CASE("Random Access Iterators") {
+    MyContainer<int> container{7, 15, 6, 1, 2};
+
+    SUBCASE("Every order reports the random access category") {
+        using Tag = std::random_access_iterator_tag;
+        CHECK(std::is_same<std::iterator_traits<MyContainer<int>::Order>::iterator_category, Tag>::value);
+        CHECK(std::is_same<std::iterator_traits<MyContainer<int>::ReverseOrder>::iterator_category, Tag>::value);
+        CHECK(std::is_same<std::iterator_traits<MyContainer<int>::AscendingOrder>::iterator_category, Tag>::value);
+        CHECK(std::is_same<std::iterator_traits<MyContainer<int>::DescendingOrder>::iterator_category, Tag>::value);
+        CHECK(std::is_same<std::iterator_traits<MyContainer<int>::SideCrossOrder>::iterator_category, Tag>::value);
+        CHECK(std::is_same<std::iterator_traits<MyContainer<int>::MiddleOutOrder>::iterator_category, Tag>::value);
+    }
+
+    SUBCASE("Offsets, subscripts and distances match forward iteration") {
+        auto check_order = [](auto view) {
+            std::vector<int> forward(view.begin(), view.end());
+            auto first = view.begin();
+            auto last = view.end();
+            REQUIRE(last - first == static_cast<std::ptrdiff_t>(forward.size()));
+            CHECK(std::distance(first, last) == static_cast<std::ptrdiff_t>(forward.size()));
+            for (size_t k = 0; k < forward.size(); ++k) {
+                std::ptrdiff_t d = static_cast<std::ptrdiff_t>(k);
+                CHECK(first[d] == forward[k]);
+                CHECK(*(first + d) == forward[k]);
+                CHECK(*(d + first) == forward[k]);
+                CHECK(*(last - (static_cast<std::ptrdiff_t>(forward.size()) - d)) == forward[k]);
+                CHECK((first + d) - first == d);
+                CHECK(first + d < last);
+                CHECK(last > first + d);
+            }
+            std::vector<int> backward(std::make_reverse_iterator(last), std::make_reverse_iterator(first));
+            CHECK(std::equal(backward.begin(), backward.end(), forward.rbegin(), forward.rend()));
+        };
+        check_order(container.order());
+        check_order(container.reverse_order());
+        check_order(container.ascending_order());
+        check_order(container.descending_order());
+        check_order(container.side_cross_order());
+        check_order(container.middle_out_order());
+    }
+
+    SUBCASE("Movement saturates at both ends") {
+        auto it = container.order();
+        --it;
+        CHECK(it == container.order().begin());
+        it += 100;
+        CHECK(it == container.order().end());
+        ++it;
+        CHECK(it == container.order().end());
+        it -= 100;
+        CHECK(*it == 7);
+        it += -3;
+        CHECK(*it == 7);
+        CHECK_THROWS_AS(it[5], std::out_of_range);
+        CHECK(it[4] == 2);
+    }
+
+    SUBCASE("Sorted views work with standard binary search") {
+        auto view = container.ascending_order();
+        CHECK(std::binary_search(view.begin(), view.end(), 6));
+        CHECK_FALSE(std::binary_search(view.begin(), view.end(), 8));
+        auto pos = std::lower_bound(view.begin(), view.end(), 7);
+        CHECK(pos - view.begin() == 3);
+        CHECK(*pos == 7);
+        CHECK(std::upper_bound(view.begin(), view.end(), 100) == view.end());
+    }
+
+    SUBCASE("Default constructed iterators compare equal") {
+        MyContainer<int>::AscendingOrder a;
+        MyContainer<int>::AscendingOrder b;
+        CHECK(a == b);
+    }
+}
+
+TEST_CASE("Shared Sorted Permutation") {
+    SUBCASE("Iterator copies and postfix increments do not touch the permutation") {
+        CHECK(std::is_trivially_copyable<MyContainer<int>::AscendingOrder>::value);
+        CHECK(sizeof(MyContainer<int>::SideCrossOrder) == sizeof(const void*) + sizeof(size_t));
+
+        MyContainer<CountingInt> container;
+        for (int i = 0; i < 2000; ++i) container.add((i * 37) % 2003);
+        auto it = container.ascending_order();
+        CHECK((*it).value == 0);
+
+        CountingInt::comparisons = 0;
+        int previous = -1;
+        for (auto end = it.end(); it != end; it++) {
+            auto copy = it;
+            CHECK((*copy).value > previous);
+            previous = (*copy).value;
+        }
+        CHECK(CountingInt::comparisons == 0);
+    }
+
+    SUBCASE("Container copies share the permutation until one of them changes") {
+        MyContainer<CountingInt> original;
+        for (int val : {5, 3, 9, 1, 7}) original.add(val);
+        CHECK((*original.ascending_order()).value == 1);
+
+        CountingInt::comparisons = 0;
+        MyContainer<CountingInt> copy(original);
+        CHECK((*copy.descending_order()).value == 9);
+        CHECK(CountingInt::comparisons == 0);
+
+        copy.add(0);
+        CHECK((*copy.ascending_order()).value == 0);
+        CHECK((*original.ascending_order()).value == 1);
+        std::vector<int> values;
+        for (const auto& val : original.ascending_order()) values.push_back(val.value);
+        CHECK(values == std::vector<int>{1, 3, 5, 7, 9});
+    }
+
+    SUBCASE("Incremental sorting of a shared permutation leaves the other copy intact") {
+        MyContainer<int> original;
+        std::vector<int> sorted;
+        for (int i = 0; i < 1000; ++i) {
+            original.add((i * 7919) % 1009);
+            sorted.push_back((i * 7919) % 1009);
+        }
+        std::sort(sorted.begin(), sorted.end());
+        original.set_sort_mode(SortMode::Incremental);
+        CHECK(*original.ascending_order() == 0);
+
+        MyContainer<int> copy(original);
+        auto back = copy.descending_order();
+        CHECK(*back == sorted.back());
+        CHECK(*(original.ascending_order() + 500) == sorted[500]);
+        CHECK(*(copy.ascending_order() + 500) == sorted[500]);
+    }
+}
+
+TEST_CASE("Compact Permutation Indices") {
+    SUBCASE("Permutation width follows the container size") {
+        for (size_t n : {size_t(1000), size_t(65536), size_t(65537), size_t(70000)}) {
+            MyContainer<int> container;
+            for (size_t i = 0; i < n; ++i) container.add(static_cast<int>((i * 7919) % n));
+            size_t before = container.memory_usage();
+            CHECK(*container.ascending_order() == 0);
+            size_t width = n <= 65536 ? sizeof(uint16_t) : sizeof(uint32_t);
+            CHECK(container.memory_usage() - before == n * width);
+        }
+    }
+
+    SUBCASE("Views are correct on both sides of the 16-bit boundary") {
+        for (size_t n : {size_t(65535), size_t(65536), size_t(65537)}) {
+            std::vector<uint64_t> bits = random_bits(n);
+            std::vector<int> ints;
+            for (uint64_t b : bits) ints.push_back(static_cast<int>(b % 1000));
+            check_ascending_matches_stable_sort(ints);
+
+            MyContainer<int> container(ints);
+            container.set_sort_mode(SortMode::Incremental);
+            auto last = container.descending_order();
+            CHECK(*last == *std::max_element(ints.begin(), ints.end()));
+            auto cross = container.side_cross_order();
+            CHECK(*cross == *std::min_element(ints.begin(), ints.end()));
+        }
+    }
+}
+
+namespace {
+    /**
+     * @brief Memory resource that counts what passes through it
+     */
+    class CountingResource : public std::pmr::memory_resource {
+    public:
+        size_t allocations = 0;
+        size_t outstanding = 0;
+
+    private:
+        void* do_allocate(size_t bytes, size_t alignment) override {
+            ++allocations;
+            outstanding += bytes;
+            return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+        }
+
+        void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+            outstanding -= bytes;
+            std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+            return this == &other;
+        }
+    };
+
+    /**
+     * @brief Makes every pmr allocation that falls back to the default resource throw
+     */
+    struct NoDefaultResource {
+        std::pmr::memory_resource* previous;
+        NoDefaultResource() : previous(std::pmr::set_default_resource(std::pmr::null_memory_resource())) {}
+        ~NoDefaultResource() { std::pmr::set_default_resource(previous); }
+    };
+}
+
+TEST_CASE("Allocator Support") {
+    SUBCASE("Elements and every sorted structure use the supplied resource") {
+        CountingResource resource;
+        {
+            NoDefaultResource guard;
+            for (SortMode mode : {SortMode::Full, SortMode::Incremental, SortMode::Maintained}) {
+                pmr::MyContainer<int> container(&resource);
+                container.set_sort_mode(mode);
+                for (int i = 0; i < 3000; ++i) container.add((i * 7919) % 3001);
+                CHECK(*container.ascending_order() == 0);
+                CHECK(*container.descending_order() == 3000);
+                CHECK(*(container.side_cross_order() + 1) == 3000);
+                container.remove(0);
+                container.add(-1);
+                CHECK(*container.ascending_order() == -1);
+                CHECK(*container.ascending_order(execution::par(2)) == -1);
+
+                pmr::MyContainer<int> copy(container, &resource);
+                copy.add(5000);
+                CHECK(*copy.descending_order() == 5000);
+                CHECK(*container.descending_order() == 3000);
+            }
+        }
+        CHECK(resource.allocations > 0);
+        CHECK(resource.outstanding == 0);
+    }
+
+    SUBCASE("A monotonic arena backs the container") {
+        std::array<std::byte, 1 << 16> buffer;
+        std::pmr::monotonic_buffer_resource arena(buffer.data(), buffer.size(), std::pmr::null_memory_resource());
+        pmr::MyContainer<int> container({4, 1, 3, 2}, &arena);
+        std::vector<int> ascending(container.ascending_order().begin(), container.ascending_order().end());
+        CHECK(ascending == std::vector<int>{1, 2, 3, 4});
+        CHECK(container.get_allocator().resource() == &arena);
+    }
+
+    SUBCASE("Copies follow std::vector allocator rules") {
+        CountingResource resource;
+        pmr::MyContainer<int> container({5, 3, 9}, &resource);
+        CHECK(*container.ascending_order() == 3);
+
+        pmr::MyContainer<int> copy(container);
+        CHECK(copy.get_allocator().resource() == std::pmr::get_default_resource());
+        CHECK(*copy.ascending_order() == 3);
+
+        pmr::MyContainer<int> assigned(&resource);
+        assigned = copy;
+        CHECK(assigned.get_allocator().resource() == &resource);
+        copy.add(1);
+        CHECK(*assigned.ascending_order() == 3);
+        CHECK(*copy.ascending_order() == 1);
+
+        pmr::MyContainer<int> moved(&resource);
+        moved = std::move(copy);
+        CHECK(moved.get_allocator().resource() == &resource);
+        CHECK(*moved.ascending_order() == 1);
+        CHECK(moved.size() == 4);
+    }
+}
+
+TEST_CASE("Small Container") {
+    auto all_orders = [](const auto& container) {
+        std::vector<std::vector<int>> orders(6);
+        for (const auto& val : container.order()) orders[0].push_back(val);
+        for (const auto& val : container.reverse_order()) orders[1].push_back(val);
+        for (const auto& val : container.ascending_order()) orders[2].push_back(val);
+        for (const auto& val : container.descending_order()) orders[3].push_back(val);
+        for (const auto& val : container.side_cross_order()) orders[4].push_back(val);
+        for (const auto& val : container.middle_out_order()) orders[5].push_back(val);
+        return orders;
+    };
+
+    SUBCASE("Up to N elements never allocate") {
+        pmr::SmallContainer<int, 16> container(std::pmr::null_memory_resource());
+        MyContainer<int> reference;
+        for (int i = 0; i < 16; ++i) {
+            container.add((i * 7) % 16);
+            reference.add((i * 7) % 16);
+            CHECK(all_orders(container) == all_orders(reference));
+        }
+        container.remove(3);
+        container.remove_unordered(5);
+        reference.remove(3);
+        reference.remove_unordered(5);
+        container[0] = 42;
+        reference[0] = 42;
+        CHECK(all_orders(container) == all_orders(reference));
+        CHECK(container.memory_usage() == sizeof(container));
+        CHECK_THROWS_AS(container.append(reference.order().begin(), reference.order().end()), std::bad_alloc);
+    }
+
+    SUBCASE("Growing past N spills to the heap") {
+        SmallContainer<int, 8> container;
+        MyContainer<int> reference;
+        for (int i = 0; i < 100; ++i) {
+            container.add((i * 37) % 101);
+            reference.add((i * 37) % 101);
+            if (i % 7 == 0) CHECK(all_orders(container) == all_orders(reference));
+        }
+        CHECK(all_orders(container) == all_orders(reference));
+        CHECK(container.capacity() >= 100);
+        CHECK(container.memory_usage() > sizeof(container));
+
+        container.set_sort_mode(SortMode::Maintained);
+        reference.set_sort_mode(SortMode::Maintained);
+        container.add(-3);
+        reference.add(-3);
+        CHECK(all_orders(container) == all_orders(reference));
+    }
+
+    SUBCASE("Copies and moves of inline and spilled containers") {
+        SmallContainer<std::string, 4> inline_strings{"pear", "fig", "apple"};
+        CHECK(*inline_strings.ascending_order() == "apple");
+        SmallContainer<std::string, 4> copy(inline_strings);
+        copy.add("banana");
+        CHECK(*(copy.ascending_order() + 1) == "banana");
+        CHECK(*(inline_strings.ascending_order() + 1) == "fig");
+
+        SmallContainer<std::string, 4> moved(std::move(copy));
+        CHECK(moved.size() == 4);
+        CHECK(copy.size() == 0);
+        moved.add("cherry");
+        moved.add("date");
+        CHECK(*moved.descending_order() == "pear");
+
+        SmallContainer<std::string, 4> assigned;
+        assigned = moved;
+        assigned = std::move(inline_strings);
+        CHECK(assigned.size() == 3);
+        moved = std::move(assigned);
+        std::vector<std::string> ascending(moved.ascending_order().begin(), moved.ascending_order().end());
+        CHECK(ascending == std::vector<std::string>{"apple", "fig", "pear"});
+    }
+
+    SUBCASE("Batch removal and bulk construction") {
+        std::vector<int> values = {9, 2, 7, 4, 5, 6, 3, 8, 1};
+        SmallContainer<int, 4> container(values);
+        CHECK(container.remove_if([](int v) { return v % 2 == 0; }) == 4);
+        container.erase(0, 1);
+        std::vector<int> inserted(container.order().begin(), container.order().end());
+        CHECK(inserted == std::vector<int>{7, 5, 3, 1});
+        CHECK(*container.ascending_order() == 1);
+    }
+}
+
+TEST_CASE("Segmented Container") {
+    auto all_orders = [](const auto& container) {
+        std::vector<std::vector<int>> orders(6);
+        for (const auto& val : container.order()) orders[0].push_back(val);
+        for (const auto& val : container.reverse_order()) orders[1].push_back(val);
+        for (const auto& val : container.ascending_order()) orders[2].push_back(val);
+        for (const auto& val : container.descending_order()) orders[3].push_back(val);
+        for (const auto& val : container.side_cross_order()) orders[4].push_back(val);
+        for (const auto& val : container.middle_out_order()) orders[5].push_back(val);
+        return orders;
+    };
+
+    SUBCASE("All orders match the vector-backed container") {
+        SegmentedContainer<int, std::allocator<int>, 8> container;
+        MyContainer<int> reference;
+        for (int i = 0; i < 200; ++i) {
+            container.add((i * 37) % 211);
+            reference.add((i * 37) % 211);
+        }
+        CHECK(all_orders(container) == all_orders(reference));
+
+        container.remove(37);
+        reference.remove(37);
+        container.remove_unordered(74);
+        reference.remove_unordered(74);
+        container.remove_if([](int v) { return v % 5 == 0; });
+        reference.remove_if([](int v) { return v % 5 == 0; });
+        container.erase(3, 20);
+        reference.erase(3, 20);
+        container[0] = -1;
+        reference[0] = -1;
+        CHECK(all_orders(container) == all_orders(reference));
+
+        for (SortMode mode : {SortMode::Incremental, SortMode::Maintained}) {
+            container.set_sort_mode(mode);
+            reference.set_sort_mode(mode);
+            container.add(500);
+            reference.add(500);
+            CHECK(all_orders(container) == all_orders(reference));
+        }
+    }
+
+    SUBCASE("Growth never moves elements") {
+        SegmentedContainer<int, std::allocator<int>, 16> container;
+        container.add(7);
+        const int* first = &container.order()[0];
+        for (int i = 0; i < 1000; ++i) container.add(i);
+        CHECK(&container.order()[0] == first);
+        CHECK(*first == 7);
+        CHECK(container.capacity() % 16 == 0);
+        CHECK(container.capacity() - container.size() < 16);
+        CHECK(container.memory_usage() >= sizeof(container) + container.capacity() * sizeof(int));
+    }
+
+    SUBCASE("Construction, copies and moves") {
+        std::vector<std::string> words = {"kiwi", "lime", "fig", "plum", "date"};
+        SegmentedContainer<std::string, std::allocator<std::string>, 2> container(words);
+        SegmentedContainer<std::string, std::allocator<std::string>, 2> copy(container);
+        copy.add("apple");
+        CHECK(*copy.ascending_order() == "apple");
+        CHECK(*container.ascending_order() == "date");
+
+        SegmentedContainer<std::string, std::allocator<std::string>, 2> moved(std::move(copy));
+        CHECK(moved.size() == 6);
+        CHECK(copy.size() == 0);
+        copy = moved;
+        moved = std::move(container);
+        CHECK(moved.size() == 5);
+        CHECK(copy.size() == 6);
+        CHECK(*copy.descending_order() == "plum");
+
+        CountingResource resource;
+        {
+            pmr::SegmentedContainer<int> pooled({3, 1, 2}, &resource);
+            CHECK(*pooled.ascending_order() == 1);
+        }
+        CHECK(resource.allocations > 0);
+        CHECK(resource.outstanding == 0);
+    }
+}
+
+TEST_CASE("Mapped Container") {
+    std::string path = "/tmp/mycontainer_mapped_" + std::to_string(::getpid()) + ".bin";
+    std::remove(path.c_str());
+
+    auto all_orders = [](const auto& container) {
+        std::vector<std::vector<int>> orders(6);
+        for (const auto& val : container.order()) orders[0].push_back(val);
+        for (const auto& val : container.reverse_order()) orders[1].push_back(val);
+        for (const auto& val : container.ascending_order()) orders[2].push_back(val);
+        for (const auto& val : container.descending_order()) orders[3].push_back(val);
+        for (const auto& val : container.side_cross_order()) orders[4].push_back(val);
+        for (const auto& val : container.middle_out_order()) orders[5].push_back(val);
+        return orders;
+    };
+
+    SUBCASE("All orders match the vector-backed container") {
+        MappedContainer<int> container;
+        MyContainer<int> reference;
+        for (int i = 0; i < 5000; ++i) {
+            container.add((i * 37) % 4001);
+            reference.add((i * 37) % 4001);
+        }
+        CHECK_FALSE(container.storage().is_file_backed());
+        CHECK(all_orders(container) == all_orders(reference));
+
+        container.remove(37);
+        reference.remove(37);
+        container.remove_if([](int v) { return v % 5 == 0; });
+        reference.remove_if([](int v) { return v % 5 == 0; });
+        container.erase(3, 20);
+        reference.erase(3, 20);
+        container[0] = -1;
+        reference[0] = -1;
+        CHECK(all_orders(container) == all_orders(reference));
+
+        MappedContainer<int> copy(container);
+        copy.add(9999);
+        CHECK(copy.size() == container.size() + 1);
+        CHECK(*container.descending_order() != 9999);
+    }
+
+    SUBCASE("Elements persist in the file") {
+        std::vector<std::vector<int>> expected;
+        {
+            MappedContainer<int> container = open_mapped<int>(path);
+            CHECK(container.size() == 0);
+            CHECK(container.storage().is_file_backed());
+            for (int i = 0; i < 3000; ++i) container.add((i * 7919) % 1009);
+            container.storage().sync();
+            expected = all_orders(container);
+        }
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        CHECK(static_cast<size_t>(file.tellg()) == 64 + 3000 * sizeof(int));
+
+        MappedContainer<int> reopened = open_mapped<int>(path);
+        CHECK(reopened.size() == 3000);
+        CHECK(all_orders(reopened) == expected);
+        reopened.add(-5);
+        CHECK(*reopened.ascending_order() == -5);
+
+        CHECK_THROWS_AS(open_mapped<double>(path), std::runtime_error);
+        CHECK_THROWS_AS(open_mapped<int>("/nonexistent-dir/file.bin"), std::system_error);
+    }
+
+    std::remove(path.c_str());
+}
+
+TEST_CASE("Binary Serialization") {
+    std::string path = "/tmp/mycontainer_binary_" + std::to_string(::getpid()) + ".bin";
+
+    auto in_order = [](const auto& container) {
+        std::vector<typename std::decay_t<decltype(container)>::allocator_type::value_type> values;
+        for (const auto& val : container.order()) values.push_back(val);
+        return values;
+    };
+    auto sorted = [](const auto& container) {
+        std::vector<typename std::decay_t<decltype(container)>::allocator_type::value_type> values;
+        for (const auto& val : container.ascending_order()) values.push_back(val);
+        return values;
+    };
+
+    SUBCASE("Round trip of trivially copyable elements") {
+        MyContainer<int> container;
+        for (int i = 0; i < 10000; ++i) container.add((i * 7919) % 1009 - 500);
+        container.save(path);
+
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        CHECK(static_cast<size_t>(file.tellg()) == 64 + 10000 * sizeof(int));
+
+        MyContainer<int> loaded = MyContainer<int>::load(path);
+        CHECK(in_order(loaded) == in_order(container));
+        CHECK(sorted(loaded) == sorted(container));
+
+        SegmentedContainer<int, std::allocator<int>, 64> segmented = SegmentedContainer<int, std::allocator<int>, 64>::load(path);
+        CHECK(segmented.size() == 10000);
+        CHECK(sorted(segmented) == sorted(container));
+        segmented.save(path);
+        CHECK(in_order(MyContainer<int>::load(path)) == in_order(container));
+
+        MyContainer<int> empty;
+        empty.save(path);
+        CHECK(MyContainer<int>::load(path).size() == 0);
+    }
+
+    SUBCASE("Round trip of strings") {
+        MyContainer<std::string> words = {"pear", "", "apple", std::string(300, 'z'), "fig"};
+        words.save(path);
+        MyContainer<std::string> loaded = MyContainer<std::string>::load(path);
+        CHECK(in_order(loaded) == in_order(words));
+        CHECK(*loaded.ascending_order() == "");
+        CHECK(loaded[3].size() == 300);
+    }
+
+    SUBCASE("Zero-copy load through a mapping") {
+        MyContainer<double> container = {2.5, -1.0, 8.0, 3.25};
+        container.save(path);
+        MappedContainer<double> mapped = load_mapped<double>(path);
+        CHECK(mapped.size() == 4);
+        CHECK(*mapped.ascending_order() == -1.0);
+        CHECK(*mapped.descending_order() == 8.0);
+
+        mapped[0] = 100.0;
+        mapped.add(7.0);
+        CHECK(mapped.size() == 5);
+        CHECK(*mapped.descending_order() == 100.0);
+        CHECK(in_order(MyContainer<double>::load(path)) == in_order(container));
+    }
+
+    SUBCASE("Invalid input is rejected") {
+        MyContainer<int> container = {1, 2, 3};
+        container.save(path);
+        CHECK_THROWS_AS(MyContainer<long long>::load(path), std::runtime_error);
+        CHECK_THROWS_AS(MyContainer<unsigned>::load(path), std::runtime_error);
+        CHECK_THROWS_AS(MyContainer<std::string>::load(path), std::runtime_error);
+        CHECK_THROWS_AS(MyContainer<int>::load("/nonexistent-dir/file.bin"), std::system_error);
+
+        {
+            std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+            file.seekp(64 + sizeof(int));
+            int tampered = 42;
+            file.write(reinterpret_cast<const char*>(&tampered), sizeof(tampered));
+        }
+        CHECK_THROWS_WITH_AS(MyContainer<int>::load(path), "Checksum mismatch", std::runtime_error);
+        CHECK_THROWS_WITH_AS(load_mapped<int>(path), "Checksum mismatch", std::runtime_error);
+
+        std::ofstream(path, std::ios::binary | std::ios::trunc) << "MYCB";
+        CHECK_THROWS_WITH_AS(MyContainer<int>::load(path), "Unexpected end of input", std::runtime_error);
+    }
+
+    SUBCASE("Corrupt sizes fail before allocating") {
+        MyContainer<int> container = {1, 2, 3};
+        container.save(path);
+        detail::BinaryHeader header;
+        {
+            std::ifstream file(path, std::ios::binary);
+            file.read(reinterpret_cast<char*>(&header), sizeof(header));
+        }
+        auto write_header = [&path](const detail::BinaryHeader& patched) {
+            std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+            file.write(reinterpret_cast<const char*>(&patched), sizeof(patched));
+        };
+
+        detail::BinaryHeader patched = header;
+        patched.payload_bytes += 3;
+        write_header(patched);
+        CHECK_THROWS_WITH_AS(MyContainer<int>::load(path), "Payload size does not match the element count",
+                             std::runtime_error);
+
+        patched = header;
+        patched.count = (uint64_t(1) << 62) + 3;
+        write_header(patched);
+        CHECK_THROWS_WITH_AS(MyContainer<int>::load(path), "Payload size does not match the element count",
+                             std::runtime_error);
+
+        patched = header;
+        patched.count = uint64_t(1) << 40;
+        patched.payload_bytes = patched.count * sizeof(int);
+        write_header(patched);
+        CHECK_THROWS_WITH_AS(MyContainer<int>::load(path), "Unexpected end of input", std::runtime_error);
+        CHECK_THROWS_WITH_AS(load_mapped<int>(path), "Unexpected end of input", std::runtime_error);
+
+        int fds[2];
+        REQUIRE(::pipe(fds) == 0);
+        int values[3] = {1, 2, 3};
+        CHECK(::write(fds[1], &patched, sizeof(patched)) == static_cast<ssize_t>(sizeof(patched)));
+        CHECK(::write(fds[1], values, sizeof(values)) == static_cast<ssize_t>(sizeof(values)));
+        ::close(fds[1]);
+        CHECK_THROWS_WITH_AS(MyContainer<int>::load(fds[0]), "Unexpected end of input", std::runtime_error);
+        ::close(fds[0]);
+
+        MyContainer<std::string> words = {"a", "b"};
+        words.save(path);
+        {
+            std::ifstream file(path, std::ios::binary);
+            file.read(reinterpret_cast<char*>(&header), sizeof(header));
+        }
+        patched = header;
+        patched.count = uint64_t(1) << 40;
+        write_header(patched);
+        CHECK_THROWS_WITH_AS(MyContainer<std::string>::load(path), "Payload size does not match the element count",
+                             std::runtime_error);
+    }
+
+    std::remove(path.c_str());
+}
+
+TEST_CASE("Text Parsing") {
+    auto in_order = [](const auto& container) {
+        std::vector<typename std::decay_t<decltype(container)>::allocator_type::value_type> values;
+        for (const auto& val : container.order()) values.push_back(val);
+        return values;
+    };
+
+    SUBCASE("Round trip through operator<<") {
+        MyContainer<int> container;
+        for (int i = 0; i < 20000; ++i) container.add((i * 7919) % 100003 - 50000);
+        std::ostringstream os;
+        os << container;
+        MyContainer<int> parsed = MyContainer<int>::parse(os.str());
+        CHECK(in_order(parsed) == in_order(container));
+        CHECK(parsed.capacity() == parsed.size());
+        CHECK(*parsed.ascending_order() == *container.ascending_order());
+
+        MyContainer<double> reals = {0.1, -2.5e-7, 1e300, 3.0};
+        std::ostringstream precise;
+        precise.precision(17);
+        precise << reals;
+        CHECK(in_order(MyContainer<double>::parse(precise.str())) == in_order(reals));
+    }
+
+    SUBCASE("Accepted layouts") {
+        std::vector<int> expected = {1, -2, 3};
+        CHECK(in_order(MyContainer<int>::parse("[1,-2,3]")) == expected);
+        CHECK(in_order(MyContainer<int>::parse("  [ 1 , -2 ,3 ]\n")) == expected);
+        CHECK(in_order(MyContainer<int>::parse("1\n-2\n3\n")) == expected);
+        CHECK(in_order(MyContainer<int>::parse("1 -2\t3")) == expected);
+        CHECK(in_order(MyContainer<int>::parse("1,-2,\n3")) == expected);
+        CHECK(MyContainer<int>::parse("[]").size() == 0);
+        CHECK(MyContainer<int>::parse("").size() == 0);
+        CHECK(MyContainer<int>::parse(" \n").size() == 0);
+    }
+
+    SUBCASE("Malformed input is rejected") {
+        CHECK_THROWS_WITH_AS(MyContainer<int>::parse("[1,x,3]"), "Invalid element at offset 3", std::runtime_error);
+        CHECK_THROWS_WITH_AS(MyContainer<int>::parse("1,2,"), "Missing element at offset 4", std::runtime_error);
+        CHECK_THROWS_WITH_AS(MyContainer<int>::parse("1,,2"), "Invalid element at offset 2", std::runtime_error);
+        CHECK_THROWS_WITH_AS(MyContainer<int>::parse("[1,2"), "Missing ']' at offset 4", std::runtime_error);
+        CHECK_THROWS_WITH_AS(MyContainer<int>::parse("1]"), "Invalid element at offset 0", std::runtime_error);
+        CHECK_THROWS_WITH_AS(MyContainer<int>::parse("[1] 2"), "Unexpected character at offset 4", std::runtime_error);
+        CHECK_THROWS_WITH_AS(MyContainer<int>::parse("12a"), "Invalid element at offset 0", std::runtime_error);
+        CHECK_THROWS_WITH_AS(MyContainer<int16_t>::parse("1,70000"), "Element out of range at offset 2", std::runtime_error);
+    }
+
+    SUBCASE("Blocks may split anywhere") {
+        const std::string text = " [ -12, 3.5e2 ,7\n 42 ] ";
+        for (size_t cut = 0; cut <= text.size(); ++cut) {
+            detail::TextParser<double> parser;
+            std::vector<double> values;
+            auto emit = [&values](double value) { values.push_back(value); };
+            parser.feed(std::string_view(text).substr(0, cut), emit);
+            parser.feed(std::string_view(text).substr(cut), emit);
+            parser.finish(emit);
+            CHECK(values == std::vector<double>{-12, 350, 7, 42});
+        }
+
+        detail::TextParser<int> parser;
+        auto ignore = [](int) {};
+        parser.feed("[1, 2", ignore);
+        CHECK_THROWS_WITH_AS(parser.feed("3x, 4]", ignore), "Invalid element at offset 4", std::runtime_error);
+    }
+
+    SUBCASE("Reading from files and pipes") {
+        MyContainer<long long> container = {5, 1, 4000000000LL, -7};
+        std::FILE* file = std::tmpfile();
+        REQUIRE(file != nullptr);
+        container.write_to(file, container.descending_order());
+        std::rewind(file);
+        CHECK(in_order(MyContainer<long long>::read_from(file)) == std::vector<long long>{4000000000LL, 5, 1, -7});
+        std::rewind(file);
+        CHECK(in_order(MyContainer<long long>::read_from(::fileno(file))) == std::vector<long long>{4000000000LL, 5, 1, -7});
+        std::fclose(file);
+
+        MyContainer<int> big;
+        for (int i = 0; i < 300000; ++i) big.add(i);
+        int fds[2];
+        REQUIRE(::pipe(fds) == 0);
+        std::string text;
+        {
+            std::ostringstream os;
+            os << big;
+            text = os.str();
+        }
+        std::thread writer([&] {
+            const char* p = text.data();
+            size_t left = text.size();
+            while (left > 0) {
+                ssize_t n = ::write(fds[1], p, left);
+                if (n <= 0) break;
+                p += n;
+                left -= static_cast<size_t>(n);
+            }
+            ::close(fds[1]);
+        });
+        MyContainer<int> parsed = MyContainer<int>::read_from(fds[0]);
+        writer.join();
+        ::close(fds[0]);
+        CHECK(in_order(parsed) == in_order(big));
+    }
+}
+
+TEST_CASE("Concurrent Container") {
+    SUBCASE("Producers append concurrently and seal into a MyContainer") {
+        const int producers = 8;
+        const int per_thread = 20000;
+        ConcurrentContainer<int> shared(4);
+        CHECK(shared.shard_count() == 4);
+
+        std::vector<std::thread> threads;
+        for (int t = 0; t < producers; ++t) {
+            threads.emplace_back([&shared, t] {
+                for (int i = 0; i < per_thread; ++i) {
+                    if (i % 2 == 0) {
+                        shared.add(t * per_thread + i);
+                    } else {
+                        shared.emplace(t * per_thread + i);
+                    }
+                }
+            });
+        }
+        for (std::thread& thread : threads) thread.join();
+        CHECK(shared.size() == static_cast<size_t>(producers * per_thread));
+
+        MyContainer<int> snapshot = shared.snapshot();
+        CHECK(snapshot.size() == static_cast<size_t>(producers * per_thread));
+        MyContainer<int> sealed = shared.seal();
+        CHECK(shared.size() == 0);
+        REQUIRE(sealed.size() == static_cast<size_t>(producers * per_thread));
+
+        std::vector<int> last(producers, -1);
+        bool per_thread_order = true;
+        for (int value : sealed.order()) {
+            int producer = value / per_thread;
+            per_thread_order = per_thread_order && value > last[producer];
+            last[producer] = value;
+        }
+        CHECK(per_thread_order);
+
+        int expected = 0;
+        bool ascending = true;
+        for (int value : sealed.ascending_order()) ascending = ascending && value == expected++;
+        CHECK(ascending);
+        CHECK(*sealed.descending_order() == producers * per_thread - 1);
+        CHECK(*sealed.side_cross_order() == 0);
+        CHECK(std::distance(sealed.middle_out_order().begin(), sealed.middle_out_order().end()) ==
+              producers * per_thread);
+    }
+
+    SUBCASE("Shards are assigned per container") {
+        ConcurrentContainer<int> shared(2);
+        ConcurrentContainer<int> other(2);
+        std::thread([&shared] { shared.add(1); }).join();
+        std::thread([&other] { other.add(10); }).join();
+        std::thread([&shared] { shared.add(2); shared.add(3); }).join();
+
+        // The second thread got the other shard, which is larger and comes first
+        MyContainer<int> sealed = shared.seal();
+        std::vector<int> values;
+        for (int value : sealed.order()) values.push_back(value);
+        CHECK(values == std::vector<int>{2, 3, 1});
+
+        shared.add(4);
+        std::thread([&shared] { shared.add(5); }).join();
+        shared.add(6);
+        sealed = shared.seal();
+        values.clear();
+        for (int value : sealed.order()) values.push_back(value);
+        CHECK(values == std::vector<int>{4, 6, 5});
+    }
+
+    SUBCASE("Sealing while producers keep adding loses nothing") {
+        ConcurrentContainer<int> shared;
+        std::atomic<bool> done{false};
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([&shared] {
+                std::vector<int> batch(100, 1);
+                for (int i = 0; i < 200; ++i) shared.append(batch.begin(), batch.end());
+            });
+        }
+        size_t sealed_total = 0;
+        std::thread sealer([&] {
+            while (!done) sealed_total += shared.seal().size();
+        });
+        for (std::thread& thread : threads) thread.join();
+        done = true;
+        sealer.join();
+        sealed_total += shared.seal().size();
+        CHECK(sealed_total == 4u * 200u * 100u);
+    }
+
+    SUBCASE("Strings and memory resources") {
+        CountingResource resource;
+        {
+            std::pmr::synchronized_pool_resource pool(&resource);
+            ConcurrentContainer<int, std::pmr::polymorphic_allocator<int>> shared(2, &pool);
+            std::thread other([&shared] { shared.add(2); });
+            shared.add(1);
+            other.join();
+            pmr::MyContainer<int> sealed = shared.seal();
+            CHECK(sealed.get_allocator().resource() == &pool);
+            CHECK(*sealed.ascending_order() == 1);
+        }
+        CHECK(resource.outstanding == 0);
+
+        ConcurrentContainer<std::string> words(3);
+        words.add("pear");
+        words.add(std::string("apple"));
+        CHECK(*words.seal().ascending_order() == "apple");
+    }
+}
+
+TEST_CASE("Concurrent Const Readers") {
+    const int n = 5000;
+    auto read_concurrently = [](const MyContainer<int>& container, int expected_size) {
+        std::atomic<int> failures{0};
+        std::vector<std::thread> readers;
+        for (int t = 0; t < 4; ++t) {
+            readers.emplace_back([&container, &failures, expected_size, t] {
+                int count = 0;
+                int previous = t % 2 == 0 ? -1 : expected_size;
+                if (t % 2 == 0) {
+                    for (int value : container.ascending_order()) {
+                        if (value <= previous) ++failures;
+                        previous = value;
+                        ++count;
+                    }
+                } else {
+                    for (int value : container.descending_order()) {
+                        if (value >= previous) ++failures;
+                        previous = value;
+                        ++count;
+                    }
+                }
+                if (count != expected_size) ++failures;
+                if (!container.contains(expected_size / 2) || container.count(expected_size) != 0) ++failures;
+            });
+        }
+        for (std::thread& reader : readers) reader.join();
+        return failures.load();
+    };
+
+    MyContainer<int> container;
+    for (int i = 0; i < n; ++i) container.add((i * 7919) % n);
+    container.enable_hash_index();
+
+    SUBCASE("Full sort mode") {
+        container.at(0) = container.at(0);
+        CHECK(read_concurrently(container, n) == 0);
+    }
+
+    SUBCASE("Incremental sort mode") {
+        container.set_sort_mode(SortMode::Incremental);
+        CHECK(read_concurrently(container, n) == 0);
+    }
+
+    SUBCASE("Maintained sort mode") {
+        container.set_sort_mode(SortMode::Maintained);
+        CHECK(read_concurrently(container, n) == 0);
+        container.add(n);
+        container.remove(n);
+        CHECK(read_concurrently(container, n) == 0);
+    }
+
+    SUBCASE("Parallel sorted views") {
+        std::thread other([&container] { container.ascending_order(execution::par(2)); });
+        container.descending_order(execution::par(2));
+        other.join();
+        CHECK(read_concurrently(container, n) == 0);
+    }
+}